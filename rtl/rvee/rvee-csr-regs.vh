@@ -43,9 +43,20 @@
 // Machine Counters/Timers
 `define CSR_MCYCLE				12'hb00
 `define CSR_MINSTRET				12'hb02
+`define CSR_MHPMCOUNTER3			12'hb03
 `define CSR_MCYCLEH				12'hb80
 `define CSR_MINSTRETH				12'hb82
+`define CSR_MHPMCOUNTER3H			12'hb83
 
 // Machine Counter Setup
 `define CSR_MCOUNTINHIBIT			12'h320
+`define CSR_MHPMEVENT3				12'h323
+
+// Unprivileged Counters/Timers
+`define CSR_CYCLE				12'hc00
+`define CSR_INSTRET				12'hc02
+`define CSR_HPMCOUNTER3				12'hc03
+`define CSR_CYCLEH				12'hc80
+`define CSR_INSTRETH				12'hc82
+`define CSR_HPMCOUNTER3H			12'hc83
 `endif
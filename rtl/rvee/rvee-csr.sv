@@ -26,6 +26,58 @@ module rvee_csr #(parameter XLEN=32, N_REGS=32) (
 	logic [XLEN - 1:0] wdata;
 	integer csr_reg = csr_if.csr_reg;
 	integer op = csr_if.op;
+	integer i, j;
+
+	// Counters. Bit 1 (time) of mcountinhibit is hardwired to zero.
+	logic [63:0] mcycle;
+	logic [63:0] minstret;
+	logic [`RVEE_HPM_LAST:0] mcountinhibit;
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+	logic [63:0] hpm [`RVEE_HPM_FIRST:`RVEE_HPM_LAST];
+	logic [`RVEE_HPM_LAST:`RVEE_HPM_FIRST] hpm_ev;
+
+always_comb begin
+	hpm_ev[`RVEE_HPM_HAZARD] = csr_if.ev_hazard;
+	hpm_ev[`RVEE_HPM_FLUSH] = csr_if.ev_flush;
+	hpm_ev[`RVEE_HPM_REDIRECT] = csr_if.ev_redirect;
+	hpm_ev[`RVEE_HPM_MEM_WAIT] = csr_if.ev_mem_wait;
+	hpm_ev[`RVEE_HPM_TRAP] = csr_if.ev_trap;
+	hpm_ev[`RVEE_HPM_IC_HIT] = csr_if.ev_ic_hit;
+	hpm_ev[`RVEE_HPM_IC_MISS] = csr_if.ev_ic_miss;
+	hpm_ev[`RVEE_HPM_DC_HIT] = csr_if.ev_dc_hit;
+	hpm_ev[`RVEE_HPM_DC_MISS] = csr_if.ev_dc_miss;
+	hpm_ev[`RVEE_HPM_DC_EVICT] = csr_if.ev_dc_evict;
+end
+`endif
+
+`ifdef RVEE_DPI_PERF
+	// Simulation only. Lets the testbench read the counters,
+	// idx is the counter number (0 mcycle, 2 minstret, 3.. mhpm).
+	import "DPI-C" function void rvee_dpi_perf_scope();
+	export "DPI-C" function rvee_dpi_perf_read;
+
+	function longint rvee_dpi_perf_read(input int idx);
+		rvee_dpi_perf_read = 0;
+		if (idx == 0) rvee_dpi_perf_read = mcycle;
+		if (idx == 2) rvee_dpi_perf_read = minstret;
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+		if (idx >= `RVEE_HPM_FIRST && idx <= `RVEE_HPM_LAST) begin
+			rvee_dpi_perf_read = hpm[idx];
+		end
+`endif
+	endfunction
+
+	initial rvee_dpi_perf_scope();
+`endif
+
+`ifdef RVEE_DPI_BACKDOOR
+	// Simulation only. While in reset, CSRs the testbench has a value
+	// for are loaded with it, e.g after fast-forwarding on the ISS.
+	// The counters are left alone.
+	import "DPI-C" function bit rvee_dpi_backdoor_csr(input int csr,
+							  output int v);
+	int bd_v;
+`endif
 
 always_comb begin
 	r = 0;
@@ -41,18 +93,45 @@ always_comb begin
 		`CSR_MISA: begin
 			r[XLEN - 1:XLEN - 2] = XLEN == 32 ? 2'b01 : 2'b10;
 			r[8] = 1'b1;
+`ifdef RVEE_CONFIG_C
+			r[2] = 1'b1;
+`endif
+`ifdef RVEE_CONFIG_M
+			r[12] = 1'b1;
+`endif
 		end
 		`CSR_MIE: begin
 			r[3] = csr_if.msie;
 			r[7] = csr_if.mtie;
-			r[11] = csr_if.mtie;
 		end
 		`CSR_MTVEC: r = csr_if.mtvec;
 		`CSR_MSCRATCH: r = csr_if.mscratch;
 		`CSR_MEPC: r = csr_if.mepc;
 		`CSR_MCAUSE: r = csr_if.mcause;
 		`CSR_MTVAL: r = csr_if.mtval;
-		default: r = 0;
+		`CSR_MCOUNTINHIBIT: r[`RVEE_HPM_LAST:0] = mcountinhibit;
+		`CSR_MCYCLE, `CSR_CYCLE: r = mcycle[31:0];
+		`CSR_MCYCLEH, `CSR_CYCLEH: r = mcycle[63:32];
+		`CSR_MINSTRET, `CSR_INSTRET: r = minstret[31:0];
+		`CSR_MINSTRETH, `CSR_INSTRETH: r = minstret[63:32];
+		default: begin
+			r = 0;
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+			for (i = `RVEE_HPM_FIRST; i <= `RVEE_HPM_LAST; i++) begin
+				if (csr_reg == `CSR_MHPMCOUNTER3 + i - 3 ||
+				    csr_reg == `CSR_HPMCOUNTER3 + i - 3) begin
+					r = hpm[i][31:0];
+				end
+				if (csr_reg == `CSR_MHPMCOUNTER3H + i - 3 ||
+				    csr_reg == `CSR_HPMCOUNTER3H + i - 3) begin
+					r = hpm[i][63:32];
+				end
+				if (csr_reg == `CSR_MHPMEVENT3 + i - 3) begin
+					r = i;
+				end
+			end
+`endif
+		end
 		endcase
 
 `ifdef DEBUG_CSR
@@ -78,6 +157,21 @@ always_comb begin
 end
 
 always_ff @(posedge clk) begin
+	// Count first so that CSR writes below take precedence.
+	if (!mcountinhibit[0]) begin
+		mcycle <= mcycle + 1;
+	end
+	if (!mcountinhibit[2] && csr_if.ev_retire) begin
+		minstret <= minstret + 1;
+	end
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+	for (j = `RVEE_HPM_FIRST; j <= `RVEE_HPM_LAST; j++) begin
+		if (!mcountinhibit[j] && hpm_ev[j]) begin
+			hpm[j] <= hpm[j] + 1;
+		end
+	end
+`endif
+
 	// do writes based on OP.
 	if (csr_if.w_en && !csr_if.illegal) begin
 		case (csr_if.csr_reg)
@@ -87,14 +181,39 @@ always_ff @(posedge clk) begin
 		`CSR_MIE: begin
 			csr_if.msie <= wdata[3];
 			csr_if.mtie <= wdata[7];
-			csr_if.mtie <= wdata[11];
 		end
 		`CSR_MTVEC: csr_if.mtvec <= {wdata[XLEN - 1:2], 2'b0};
 		`CSR_MSCRATCH: csr_if.mscratch <= wdata;
-		`CSR_MEPC: csr_if.mepc <= wdata;
+		`CSR_MEPC: begin
+			// Aligned to IALIGN, like the PCs that trap.
+`ifdef RVEE_CONFIG_C
+			csr_if.mepc <= {wdata[XLEN - 1:1], 1'b0};
+`else
+			csr_if.mepc <= {wdata[XLEN - 1:2], 2'b0};
+`endif
+		end
 		`CSR_MCAUSE: csr_if.mcause <= wdata;
 		`CSR_MTVAL: csr_if.mtval <= wdata;
-		default: begin end
+		`CSR_MCOUNTINHIBIT: begin
+			mcountinhibit <= wdata[`RVEE_HPM_LAST:0];
+			mcountinhibit[1] <= 0;
+		end
+		`CSR_MCYCLE: mcycle[31:0] <= wdata;
+		`CSR_MCYCLEH: mcycle[63:32] <= wdata;
+		`CSR_MINSTRET: minstret[31:0] <= wdata;
+		`CSR_MINSTRETH: minstret[63:32] <= wdata;
+		default: begin
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+			for (j = `RVEE_HPM_FIRST; j <= `RVEE_HPM_LAST; j++) begin
+				if (csr_reg == `CSR_MHPMCOUNTER3 + j - 3) begin
+					hpm[j][31:0] <= wdata;
+				end
+				if (csr_reg == `CSR_MHPMCOUNTER3H + j - 3) begin
+					hpm[j][63:32] <= wdata;
+				end
+			end
+`endif
+		end
 		endcase
 `ifdef DEBUG_CSR
 		$display("CSR: pc %x write %x <= %x", csr_if.pc, csr_if.csr_reg, wdata);
@@ -116,6 +235,40 @@ always_ff @(posedge clk) begin
 
 		csr_if.mie <= 0;
 		csr_if.sie <= 0;
+
+		mcycle <= 0;
+		minstret <= 0;
+		mcountinhibit <= 0;
+`ifdef RVEE_CONFIG_HPM_COUNTERS
+		for (j = `RVEE_HPM_FIRST; j <= `RVEE_HPM_LAST; j++) begin
+			hpm[j] <= 0;
+		end
+`endif
+`ifdef RVEE_DPI_BACKDOOR
+		if (rvee_dpi_backdoor_csr(`CSR_MSTATUS, bd_v)) begin
+			csr_if.mie <= bd_v[3];
+			csr_if.mpie <= bd_v[7];
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MIE, bd_v)) begin
+			csr_if.msie <= bd_v[3];
+			csr_if.mtie <= bd_v[7];
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MTVEC, bd_v)) begin
+			csr_if.mtvec <= {bd_v[XLEN - 1:2], 2'b0};
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MSCRATCH, bd_v)) begin
+			csr_if.mscratch <= bd_v;
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MEPC, bd_v)) begin
+			csr_if.mepc <= bd_v;
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MCAUSE, bd_v)) begin
+			csr_if.mcause <= bd_v;
+		end
+		if (rvee_dpi_backdoor_csr(`CSR_MTVAL, bd_v)) begin
+			csr_if.mtval <= bd_v;
+		end
+`endif
 	end
 end
 `endif
@@ -0,0 +1,299 @@
+/*
+ * RVee data cache.
+ *
+ * Sits between the mem unit and the data AXI port. Write-back and
+ * write-allocate. Towards mem it looks like an AXI-Lite target that
+ * serves one access at a time: hits are accepted right away and
+ * respond the next cycle, misses are held (no ready) while the dirty
+ * victim is written back and the line refilled with back-to-back
+ * single-word accesses, after which they hit.
+ *
+ * Accesses at or above RVEE_CONFIG_IO_BASE go straight through.
+ * flush writes back all dirty lines, clean is set when there are none.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* verilator lint_off DECLFILENAME */
+`include "include/axi.svh"
+`include "rvee/rvee-config.svh"
+
+module rvee_dcache #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
+	input clk,
+	input rst,
+	input flush,		// FENCE.I, write back dirty lines.
+	output clean,		// No dirty lines.
+	output ev_hit,
+	output ev_miss,
+	output ev_evict,
+	axi4lite_if.target_port s_if,	// From mem.
+	axi4lite_if.master_port m_if);	// To memory.
+
+	localparam WAYS = `RVEE_CONFIG_DCACHE_WAYS;
+	localparam SET_BITS = `RVEE_CONFIG_DCACHE_SET_BITS;
+	localparam LINE_BITS = `RVEE_CONFIG_DCACHE_LINE_BITS;
+	localparam SETS = 1 << SET_BITS;
+	localparam WORDS = 1 << LINE_BITS;
+	localparam LINES = WAYS * SETS;
+	localparam TAG_LSB = 2 + LINE_BITS + SET_BITS;
+	localparam LINE_IDX_BITS = $clog2(LINES);
+
+	// Lines are laid out way after way, i.e index way * SETS + set.
+	// Words are indexed {line, word}.
+	logic	v[LINES];
+	logic	[LINES - 1:0] d;
+	logic	[AWIDTH - 1:TAG_LSB] tag[LINES];
+	logic	[DWIDTH - 1:0] data[LINES * WORDS];
+	// Next way to replace in a set (2-way only).
+	logic	lru[SETS];
+
+	assign	m_if.arprot = 0;
+	assign	m_if.awprot = 0;
+	assign	m_if.rready = 1;
+	assign	m_if.bready = 1;
+
+	// Line write-back.
+	logic	wb;
+	logic	[AWIDTH - 1:2 + LINE_BITS] wb_addr;
+	logic	[LINE_IDX_BITS - 1:0] wb_line;
+	logic	[LINE_BITS:0] wb_aw;
+	logic	[LINE_BITS:0] wb_w;
+	logic	[LINE_BITS - 1:0] wb_b;
+
+	// Line refill, starts once the victim has been written back.
+	logic	fill;
+	logic	[AWIDTH - 1:2 + LINE_BITS] fill_addr;
+	logic	[LINE_IDX_BITS - 1:0] fill_line;
+	logic	fill_err;
+	logic	[LINE_BITS:0] ar_cnt;
+	logic	[LINE_BITS - 1:0] r_cnt;
+
+	// A failed refill leaves its line uncached, accesses to it go
+	// through so that mem sees the error.
+	logic	err;
+	logic	[AWIDTH - 1:2 + LINE_BITS] err_addr;
+
+	// Uncached access in flight.
+	logic	pass;
+	logic	pass_rd;
+
+	// Reads first. Writes need both AW and W.
+	wire	rd_req = s_if.arvalid && s_if.ridle;
+	wire	wr_req = s_if.awvalid && s_if.wvalid && s_if.bidle;
+	wire	busy = wb || fill || pass;
+	wire	req = !busy && (rd_req || wr_req);
+
+	wire	[AWIDTH - 1:0] addr = rd_req ? s_if.araddr : s_if.awaddr;
+	wire	[SET_BITS - 1:0] set = addr[TAG_LSB - 1:2 + LINE_BITS];
+	wire	[LINE_BITS - 1:0] word = addr[2 + LINE_BITS - 1:2];
+	wire	uncached = addr >= `RVEE_CONFIG_IO_BASE ||
+			   (err && addr[AWIDTH - 1:2 + LINE_BITS] == err_addr);
+
+	logic	hit;
+	logic	hit_way;
+	logic	[LINE_IDX_BITS - 1:0] hit_line;
+	integer	w;
+	always_comb begin
+		hit = 0;
+		hit_way = 0;
+		hit_line = 0;
+		for (w = 0; w < WAYS; w++) begin
+			if (v[w * SETS + set] &&
+			    tag[w * SETS + set] == addr[AWIDTH - 1:TAG_LSB]) begin
+				hit = 1;
+				hit_way = w[0];
+				hit_line = w[LINE_IDX_BITS - 1:0] * SETS + set;
+			end
+		end
+	end
+
+	wire	take = req && (uncached || hit);
+	wire	miss = req && !uncached && !hit;
+	wire	victim = WAYS > 1 ? lru[set] : 0;
+	wire	[LINE_IDX_BITS - 1:0] victim_line = victim * SETS + set;
+
+	assign	s_if.arready = take && rd_req;
+	assign	s_if.awready = take && !rd_req;
+	assign	s_if.wready = take && !rd_req;
+
+	// Dirty line to write back for a flush, lowest index first.
+	logic	[LINE_IDX_BITS - 1:0] flush_line;
+	integer	l;
+	always_comb begin
+		flush_line = 0;
+		for (l = LINES - 1; l >= 0; l--) begin
+			if (d[l]) begin
+				flush_line = l[LINE_IDX_BITS - 1:0];
+			end
+		end
+	end
+	wire	do_flush = !busy && !req && flush && d != 0;
+
+	assign	clean = d == 0 && !wb;
+	assign	ev_hit = take && !uncached;
+	assign	ev_miss = miss;
+	assign	ev_evict = (miss && v[victim_line] && d[victim_line]) || do_flush;
+
+	integer i, b;
+	always_ff @(posedge clk) begin
+		if (s_if.rdone) begin
+			s_if.rvalid <= 0;
+		end
+		if (s_if.bdone) begin
+			s_if.bvalid <= 0;
+		end
+		if (m_if.ardone) begin
+			m_if.arvalid <= 0;
+		end
+		if (m_if.awdone) begin
+			m_if.awvalid <= 0;
+		end
+		if (m_if.wdone) begin
+			m_if.wvalid <= 0;
+		end
+
+		if (take && uncached) begin
+			pass <= 1;
+			pass_rd <= rd_req;
+			if (rd_req) begin
+				m_if.arvalid <= 1;
+				m_if.araddr <= s_if.araddr;
+			end else begin
+				m_if.awvalid <= 1;
+				m_if.awaddr <= s_if.awaddr;
+				m_if.wvalid <= 1;
+				m_if.wdata <= s_if.wdata;
+				m_if.wstrb <= s_if.wstrb;
+			end
+		end
+		if (pass && pass_rd && m_if.rdone) begin
+			pass <= 0;
+			s_if.rvalid <= 1;
+			s_if.rdata <= m_if.rdata;
+			s_if.rresp <= m_if.rresp;
+		end
+		if (pass && !pass_rd && m_if.bdone) begin
+			pass <= 0;
+			s_if.bvalid <= 1;
+			s_if.bresp <= m_if.bresp;
+		end
+
+		if (take && !uncached) begin
+			if (rd_req) begin
+				s_if.rvalid <= 1;
+				s_if.rdata <= data[{hit_line, word}];
+				s_if.rresp <= 0;
+			end else begin
+				for (b = 0; b < DWIDTH / 8; b++) begin
+					if (s_if.wstrb[b]) begin
+						data[{hit_line, word}][b * 8 +: 8] <= s_if.wdata[b * 8 +: 8];
+					end
+				end
+				d[hit_line] <= 1;
+				s_if.bvalid <= 1;
+				s_if.bresp <= 0;
+			end
+			lru[set] <= !hit_way;
+		end
+
+		if (miss) begin
+			if (v[victim_line] && d[victim_line]) begin
+				wb <= 1;
+				wb_addr <= {tag[victim_line], set};
+				wb_line <= victim_line;
+				wb_aw <= 0;
+				wb_w <= 0;
+				wb_b <= 0;
+			end
+			fill <= 1;
+			fill_addr <= addr[AWIDTH - 1:2 + LINE_BITS];
+			fill_line <= victim_line;
+			fill_err <= 0;
+			ar_cnt <= 0;
+			r_cnt <= 0;
+			err <= 0;
+			v[victim_line] <= 0;
+			d[victim_line] <= 0;
+			lru[set] <= !victim;
+		end
+
+		if (do_flush) begin
+			wb <= 1;
+			wb_addr <= {tag[flush_line], flush_line[SET_BITS - 1:0]};
+			wb_line <= flush_line;
+			wb_aw <= 0;
+			wb_w <= 0;
+			wb_b <= 0;
+			d[flush_line] <= 0;
+		end
+
+		// Write back the victim, all words in flight.
+		if (wb && wb_aw < WORDS && m_if.awidle) begin
+			m_if.awvalid <= 1;
+			m_if.awaddr <= {wb_addr, wb_aw[LINE_BITS - 1:0], 2'b00};
+			wb_aw <= wb_aw + 1;
+		end
+		if (wb && wb_w < WORDS && m_if.widle) begin
+			m_if.wvalid <= 1;
+			m_if.wdata <= data[{wb_line, wb_w[LINE_BITS - 1:0]}];
+			m_if.wstrb <= '1;
+			wb_w <= wb_w + 1;
+		end
+		if (wb && m_if.bdone) begin
+			wb_b <= wb_b + 1;
+			if (wb_b == WORDS - 1) begin
+				wb <= 0;
+			end
+		end
+
+		// Then refill it.
+		if (fill && !wb && ar_cnt < WORDS && m_if.aridle) begin
+			m_if.arvalid <= 1;
+			m_if.araddr <= {fill_addr, ar_cnt[LINE_BITS - 1:0], 2'b00};
+			ar_cnt <= ar_cnt + 1;
+		end
+		if (fill && m_if.rdone) begin
+			data[{fill_line, r_cnt}] <= m_if.rdata;
+			if (m_if.rresp != 0) begin
+				fill_err <= 1;
+			end
+			r_cnt <= r_cnt + 1;
+			if (r_cnt == WORDS - 1) begin
+				fill <= 0;
+				v[fill_line] <= !fill_err && m_if.rresp == 0;
+				tag[fill_line] <= fill_addr[AWIDTH - 1:TAG_LSB];
+				err <= fill_err || m_if.rresp != 0;
+				err_addr <= fill_addr;
+			end
+		end
+
+		if (rst) begin
+			wb <= 0;
+			fill <= 0;
+			pass <= 0;
+			err <= 0;
+			d <= 0;
+			s_if.rvalid <= 0;
+			s_if.bvalid <= 0;
+			m_if.arvalid <= 0;
+			m_if.awvalid <= 0;
+			m_if.wvalid <= 0;
+			for (i = 0; i < LINES; i++) begin
+				v[i] <= 0;
+			end
+			for (i = 0; i < SETS; i++) begin
+				lru[i] <= 0;
+			end
+		end
+`ifdef DEBUG_DCACHE
+		if (req) begin
+			$display("DC: %s %x %s way=%d", rd_req ? "rd" : "wr", addr,
+				uncached ? "uncached" : hit ? "hit" : "miss",
+				hit ? hit_way : victim);
+		end
+`endif
+	end
+endmodule
@@ -35,15 +35,29 @@ module rvee_decode #(parameter XLEN=32) (
 	wire flush_jmp = pcgen_if.jmp || pcgen_if.jmp_out;
 	logic flush;
 	logic flush_ff;
+	logic ld_wait;
 
 	wire	[XLEN - 1:0] iw = fetch_if.iw;
 	wire	[XLEN - 1:0] pc = fetch_if.pc;
+	// Insn length, for links and fall-throughs.
+	wire	[XLEN - 1:0] ilen = fetch_if.rvc ? 2 : 4;
 	rvee_decode_pkg::decoded_insn_t dec;
 	logic [19:0] sign_ext;
 
 	insn_t insn;
 	assign insn = iw;
 
+`ifdef RVEE_CONFIG_BCC_DECODE
+	// Branch conditions, on the same (forwarded) operands EX would see.
+	wire	bcc_eq = rf_if.rs1_data == rf_if.rs2_data;
+	wire	bcc_lt = $signed(rf_if.rs1_data) < $signed(rf_if.rs2_data);
+	wire	bcc_ltu = rf_if.rs1_data < rf_if.rs2_data;
+	// funct3[0] inverts BEQ/BLT/BLTU into BNE/BGE/BGEU.
+	wire	bcc_taken = insn.b.funct3[0] ^
+			    (!insn.b.funct3[2] ? bcc_eq :
+			     insn.b.funct3[1] ? bcc_ltu : bcc_lt);
+`endif
+
 	always_comb begin
 		rf_if.rs1 = insn.r.rs1;
 		rf_if.rs2 = insn.r.rs2;
@@ -59,6 +73,7 @@ module rvee_decode #(parameter XLEN=32) (
 		dec.b = 'dx;
 		dec.c = 0;
 		dec.sra = 1'bx;
+		dec.muldiv = 0;
 
 		dec.mem_load = 0;
 		dec.mem_store = 0;
@@ -70,8 +85,12 @@ module rvee_decode #(parameter XLEN=32) (
 		dec.jmp_offset = 32'bx;
 		dec.bcc = 0;
 		dec.bcc_n = 1'bx;
+		dec.pred = 0;
+		dec.jal = 0;
+		dec.fence_i = 0;
 		dec.ecall = 0;
 		dec.ebreak = 0;
+		dec.trap = 0;
 		dec.msb_xor = 0;
 `ifdef RVEE_ZICSR
 		csr_if.pc = pc;
@@ -101,9 +120,11 @@ module rvee_decode #(parameter XLEN=32) (
 			/* JAL  */
 			dec.op = `ALU_ADD;
 			dec.a = pc;
-			dec.b = 4;
+			dec.b = ilen;
 			dec.rd_we = 1;
-			dec.jmp = 1;
+			// With branch prediction, JALs redirect from DECODE.
+			dec.jmp = `RVEE_CONFIG_BPRED == 0;
+			dec.jal = 1;
 			dec.jmp_base = pc;
 			/* Frankenstein immediate.  */
 			dec.jmp_offset = {sign_ext[10:0], insn.j.imm4, insn.j.imm3,
@@ -122,6 +143,8 @@ module rvee_decode #(parameter XLEN=32) (
 			dec.jmp_base = pc;
 			dec.jmp_offset = {sign_ext[18:0], insn.b.imm4, insn.b.imm3,
 						insn.b.imm2, insn.b.imm, 1'b0};
+			// BTFN, backward branches are predicted taken.
+			dec.pred = `RVEE_CONFIG_BPRED != 0 && iw[31];
 		end
 		7'b0100011: begin
 			/* Stores always do additions through the ALU.  */
@@ -149,7 +172,7 @@ module rvee_decode #(parameter XLEN=32) (
 			dec.jmp_offset = {sign_ext, insn.i.imm};
 			if (dec.jmp) begin
 				dec.a = pc;
-				dec.b = 4;
+				dec.b = ilen;
 			end
 
 			dec.msb_xor = dec.b[XLEN - 1];
@@ -175,9 +198,24 @@ module rvee_decode #(parameter XLEN=32) (
 				dec.b = ~rf_if.rs2_data;
 			end
 			dec.rd_we = 1;
+`ifdef RVEE_CONFIG_M
+			/* MUL/DIV, funct3 selects the op in rvee_muldiv.  */
+			if (insn.r.funct7 == 7'b0000001) begin
+				dec.muldiv = 1;
+				dec.b = rf_if.rs2_data;
+				dec.c = 0;
+			end
+`endif
 		end
 		/* FENCE.  */
 		7'b0001111: begin
+			/* FENCE.I, refetch everything after it.  */
+			if (insn.i.funct3[0]) begin
+				dec.fence_i = 1;
+				dec.jmp = 1;
+				dec.jmp_base = pc;
+				dec.jmp_offset = ilen;
+			end
 		end
 		/* SYSTEM.  */
 		7'b1110011: begin
@@ -258,8 +296,14 @@ module rvee_decode #(parameter XLEN=32) (
 			end
 		end
 
+`ifdef RVEE_CONFIG_LOAD_REGFW
+		// Load data gets forwarded the cycle it arrives.
+		ld_wait = exec_if.mem_load && !rf_if.ld_we;
+`else
+		ld_wait = exec_if.mem_load;
+`endif
 		if (exec_if.valid &&
-			(!`RVEE_CONFIG_MEM_REGFW || exec_if.mem_load)) begin
+			(!`RVEE_CONFIG_MEM_REGFW || ld_wait)) begin
 			if (rf_if.rs1 == exec_if.rd) begin
 				dec.hazard = 1;
 			end
@@ -268,6 +312,15 @@ module rvee_decode #(parameter XLEN=32) (
 			end
 		end
 
+		// Let older stores reach memory before we refetch, through
+		// the store buffer and out of the D-cache.
+		mem_if.dc_flush = fetch_if.valid && dec.fence_i;
+		if (dec.fence_i && (!mem_if.sb_empty || !mem_if.dc_clean ||
+			(decode_if.valid && decode_if.mem_store) ||
+			(exec_if.valid && exec_if.mem_store))) begin
+			dec.hazard = 1;
+		end
+
 		// If we're dropping this insn, clear any side-effects.
 		if (dec.hazard || !fetch_if.valid) begin
 			dec.jmp = 0;
@@ -316,16 +369,60 @@ module rvee_decode #(parameter XLEN=32) (
 			// TODO: Use jmp_offset for vectored interrupts.
 			dec.jmp_offset = 0;
 
-			// Cleanup.
+			// Cleanup. What's left is a bubble that carries the
+			// trap entry down the pipe.
+			dec.trap = 1;
 			dec.hazard = 0;
+			dec.bcc = 0;
+			dec.pred = 0;
+			dec.jal = 0;
 			dec.rd_we = 0;
 			dec.mem_load = 0;
 			dec.mem_store = 0;
+			dec.muldiv = 0;
 			$display("DEC: TRAP pc %x cause %x jmp to %x",
 				csr_if.pc, csr_if.n_cause, dec.jmp_base + dec.jmp_offset);
 		end
 `endif
 		fetch_if.ready = decode_if.idle && !dec.hazard;
+
+		// Branch prediction.
+		//
+		// Redirect fetch for JALs and for branches predicted taken,
+		// unless fetch already followed the BTB to the target. If the
+		// BTB hit on something that isn't a branch or a JAL, fetch
+		// returns to pc + 4. Mispredicted branches are fixed up by EX.
+		pcgen_if.pjmp = 0;
+		pcgen_if.pjmp_base = pc;
+		pcgen_if.pjmp_offset = dec.jmp_offset;
+		if (`RVEE_CONFIG_BPRED != 0) begin
+			if (fetch_if.pred) begin
+				dec.pred = dec.bcc;
+				pcgen_if.pjmp = !dec.bcc && !dec.jal;
+				pcgen_if.pjmp_offset = ilen;
+			end else begin
+				pcgen_if.pjmp = dec.jal || dec.pred;
+			end
+		end
+`ifdef RVEE_CONFIG_BCC_DECODE
+		// Branches are resolved here. Predict the actual outcome so
+		// that EX never redirects and fix up fetch if it went the
+		// wrong way after a BTB hit.
+		if (dec.bcc) begin
+			dec.pred = bcc_taken;
+			pcgen_if.pjmp = bcc_taken != fetch_if.pred;
+			pcgen_if.pjmp_offset = bcc_taken ? dec.jmp_offset : ilen;
+		end
+`endif
+		// Only for insns that move on to EX.
+		if (!fetch_if.valid || !fetch_if.ready || flush || csr_if.exception) begin
+			pcgen_if.pjmp = 0;
+		end
+
+`ifdef RVEE_ZICSR
+		csr_if.ev_hazard = fetch_if.valid && dec.hazard;
+		csr_if.ev_flush = fetch_if.valid && flush;
+`endif
 	end
 
 	always_ff @(posedge clk) begin
@@ -351,6 +448,7 @@ module rvee_decode #(parameter XLEN=32) (
 `endif
 			decode_if.valid <= !dec.hazard && !flush;
 			decode_if.pc <= fetch_if.pc;
+			decode_if.iw <= fetch_if.iw;
 			decode_if.rd_we <= dec.rd_we;
 			decode_if.rd <= dec.rd;
 			decode_if.op <= dec.op;
@@ -359,6 +457,8 @@ module rvee_decode #(parameter XLEN=32) (
 			decode_if.msb_xor <= dec.msb_xor;
 			decode_if.c <= dec.c;
 			decode_if.sra <= dec.sra;
+			decode_if.muldiv <= dec.muldiv;
+			decode_if.rvc <= fetch_if.rvc;
 
 			decode_if.mem_load <= dec.mem_load;
 			decode_if.mem_store <= dec.mem_store;
@@ -370,8 +470,12 @@ module rvee_decode #(parameter XLEN=32) (
 			decode_if.jmp_offset <= dec.jmp_offset;
 			decode_if.bcc <= dec.bcc;
 			decode_if.bcc_n <= dec.bcc_n;
+			decode_if.pred <= dec.pred;
+			decode_if.jal <= dec.jal;
+			decode_if.fence_i <= dec.fence_i;
 
 			decode_if.ecall <= dec.ecall;
+			decode_if.trap <= dec.trap;
 		end
 
 		if (rst) begin
@@ -36,22 +36,35 @@ module rvee_exec #(parameter XLEN=32) (
 		alu_if.sra = decode_if.sra;
 	end
 
-	assign	decode_if.ready = exec_if.idle;
-
 	// Branches and jumps.
 	logic	z_dly;
 	logic	bcc_ff;
 	logic	bcc_n_ff;
+	logic	pred_ff;
+	logic	jal_ff;
+	logic	taken;
 	always_comb begin
 		// Direct jumps.
 		pcgen_if.jmp = decode_if.jmp & !flush;
 		pcgen_if.jmp_base = decode_if.jmp_base;
 		pcgen_if.jmp_offset = decode_if.jmp_offset;
+		// Branches predicted taken that fall through go to pc + 4
+		// (pc + 2 for compressed ones).
+		if (decode_if.bcc && decode_if.pred) begin
+			pcgen_if.jmp_offset = decode_if.rvc ? 2 : 4;
+		end
 
 		// BCCs are delayed with one cycle. PCGEN merges them with jmp.
 		// Moving z computation to the EXEC stage makes things worse.
+		// We only redirect on mispredicts.
 		z_dly = exec_if.result == 0;
-		pcgen_if.bcc = bcc_ff ? bcc_n_ff ^ z_dly : 0;
+		taken = bcc_n_ff ^ z_dly;
+		pcgen_if.bcc = bcc_ff ? taken ^ pred_ff : 0;
+
+		// Train the predictor with the outcome.
+		pcgen_if.bp_we = bcc_ff | jal_ff;
+		pcgen_if.bp_taken = jal_ff | taken;
+		pcgen_if.bp_jal = jal_ff;
 	end
 
 	always_comb begin
@@ -64,29 +77,59 @@ module rvee_exec #(parameter XLEN=32) (
 	// Flush/drop this insn
 	wire	flush = pcgen_if.bcc || mem_if.exception;
 
+`ifdef RVEE_CONFIG_M
+	// Divides hold the insn in decode_if until the result is ready.
+	// Flushed insns are dropped right away.
+	wire	md_ready;
+	wire	[XLEN - 1:0] md_d;
+	rvee_muldiv muldiv(
+		.clk, .rst,
+		.valid(decode_if.valid && decode_if.muldiv),
+		.done(decode_if.done),
+		.op(decode_if.op),
+		.a(decode_if.a),
+		.b(decode_if.b),
+		.ready(md_ready),
+		.d(md_d));
+
+	assign	decode_if.ready = exec_if.idle &&
+				  (!decode_if.muldiv || md_ready || flush);
+	wire	[XLEN - 1:0] result = decode_if.muldiv ? md_d : alu_if.d;
+`else
+	assign	decode_if.ready = exec_if.idle;
+	wire	[XLEN - 1:0] result = alu_if.d;
+`endif
+
 	always_ff @(posedge clk) begin
 		bcc_ff <= 0;
 		bcc_n_ff <= 0;
+		jal_ff <= 0;
 
 		if (exec_if.done) begin
 			exec_if.valid <= 0;
 		end
 
-		if (decode_if.valid && exec_if.idle) begin
+		if (decode_if.done) begin
 			exec_if.valid <= !flush;
 			exec_if.pc <= decode_if.pc;
+			exec_if.iw <= decode_if.iw;
 			exec_if.rd_we <= decode_if.rd_we & !flush;
 			exec_if.rd <= decode_if.rd;
-			exec_if.result <= alu_if.d;
+			exec_if.result <= result;
 			exec_if.mem_data <= decode_if.jmp_base;
 
 			exec_if.mem_load <= decode_if.mem_load;
 			exec_if.mem_store <= decode_if.mem_store;
 			exec_if.mem_size <= decode_if.mem_size;
 			exec_if.mem_sext <= decode_if.mem_sext;
+			exec_if.trap <= decode_if.trap;
 
 			bcc_ff <= decode_if.bcc & !flush;
 			bcc_n_ff <= decode_if.bcc_n;
+			pred_ff <= decode_if.pred;
+			jal_ff <= decode_if.jal & !flush;
+			pcgen_if.bp_pc <= decode_if.pc;
+			pcgen_if.bp_target <= decode_if.jmp_base + decode_if.jmp_offset;
 `ifdef SIM_ECALL
 			if (decode_if.ecall) begin
 				$display("ecall pc %x %x %x", decode_if.pc, decode_if.a, decode_if.b);
@@ -1,7 +1,8 @@
 /*
  * RVee fetch unit.
  *
- * Issues up to 2 multiple outstanding transactions.
+ * Issues up to DEPTH (2, 4 or 8) outstanding transactions.
+ * Returns whole 32-bit words, see rvee-rvc.sv for RV32C.
  *
  * Copyright (C) 2022 Edgar E. Iglesias.
  * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
@@ -15,7 +16,8 @@
 `include "rvee/rvee-pcgen.svh"
 `include "rvee/rvee-fetch.svh"
 
-module rvee_fetch #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
+module rvee_fetch #(parameter XLEN=32, AWIDTH=32, DWIDTH=32,
+		    DEPTH=`RVEE_CONFIG_FETCH_DEPTH) (
 	input clk,
 	input rst,
 	axi4lite_if.master_port axi_fetch_if,
@@ -31,82 +33,77 @@ module rvee_fetch #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
 	assign	axi_fetch_if.wstrb = 0; 
 	assign	axi_fetch_if.bready = 1;
 	assign	axi_fetch_if.arprot = 0;
+	assign	fetch_if.rvc = 0;
 
 	typedef struct packed {
 		logic v;
+		logic pred;
 		logic [XLEN - 1:0] pc;
 	} fetch_slot_t;
 
-	fetch_slot_t fs_ff[2];
-	fetch_slot_t fs[2];
+	// Slots are kept in order, the oldest in fs[0] and valid slots
+	// are always contiguous from 0.
+	fetch_slot_t fs_ff[DEPTH];
+	fetch_slot_t fs[DEPTH];
 
 	// Shift-reg used to drop instructions after jumps.
-	logic	[1:0] flush_ff;
-	logic	[1:0] flush;
+	// Bit i belongs to slot i.
+	logic	[DEPTH - 1:0] flush_ff;
+	logic	[DEPTH - 1:0] flush;
+	// Slot that takes the current issue, if any.
+	logic	[DEPTH - 1:0] issue_slot;
 
 	// issue_ar is true when we can issue a new fetch onto the AR-channel.
-	wire	issue_ar = pcgen_if.valid && axi_fetch_if.aridle && (!fs_ff[1].v || (axi_fetch_if.rdone));
+	wire	issue_ar = pcgen_if.valid && axi_fetch_if.aridle && (!fs_ff[DEPTH - 1].v || (axi_fetch_if.rdone));
 	assign	pcgen_if.ready = issue_ar;
-	assign	fetch_if.flush = flush[0] | flush_ff[0];
+	assign	fetch_if.flush = pcgen_if.jmp_out | flush_ff[0];
 	assign	axi_fetch_if.rready = fetch_if.idle;
 
 	integer i;
 always_comb begin
-	for (i = 0; i < 2; i++) begin
+	for (i = 0; i < DEPTH; i++) begin
 		fs[i].v = fs_ff[i].v;
 		fs[i].pc = fs_ff[i].pc;
+		fs[i].pred = fs_ff[i].pred;
 	end
 	flush = flush_ff;
 
 	// R-channel is done, shift out.
 	if (axi_fetch_if.rdone) begin
-		fs[0].v = fs[1].v;
-		fs[0].pc = fs[1].pc;
-		fs[1].v = 0;
-	end
-
-	// If we're ready to issue a new transaction, shift one in.
-	if (issue_ar) begin
-		if (!fs[0].v) begin
-			fs[0].v = 1;
-		end else begin
-			fs[1].v = 1;
-		end
-	end
-
-	/*
-	 * This is really:
-	if (issue_ar) begin
-		if (!fs[0].v]) begin
-			fs[0].pc = pcgen_if.pc;
-		end else begin
-			fs[1].pc = pcgen_if.pc;
+		for (i = 0; i < DEPTH - 1; i++) begin
+			fs[i] = fs[i + 1];
 		end
+		fs[DEPTH - 1].v = 0;
+		flush = flush_ff >> 1;
 	end
 
-	* But since pc doesn't matter if .v is 0, we can flatten it out a little.
-	* The following optimizes the path for FPGA's.
-	*/
-	if (!fs[0].v) begin
-		fs[0].pc = pcgen_if.pc;
+	// If we're ready to issue a new transaction, shift one in, into
+	// the first free slot.
+	//
+	// Since pc doesn't matter if .v is 0, the pc goes into the first
+	// free slot regardless of issue_ar. That keeps the pc muxes off
+	// the issue_ar path, which helps on FPGA's.
+	issue_slot[0] = !fs[0].v;
+	for (i = 1; i < DEPTH; i++) begin
+		issue_slot[i] = !fs[i].v && fs[i - 1].v;
 	end
-	if (issue_ar) begin
-		fs[1].pc = pcgen_if.pc;
+	for (i = 0; i < DEPTH; i++) begin
+		if (issue_slot[i]) begin
+			fs[i].pc = pcgen_if.pc;
+			fs[i].pred = pcgen_if.pred;
+			fs[i].v = issue_ar;
+		end
 	end
 
-	// Flush logic.
-	if (axi_fetch_if.rdone) begin
-		flush = flush_ff >> 1;
-	end
 	if (pcgen_if.jmp_out) begin
 		// The fetch stage is responsible for dropping any fetched insns
 		// that have not yet validly been presented to the decoder.
 		//
-		// That means {fs[1].v, fs[0].v}
-		// But since fs[1].v & issue_ar means fs[1] now holds the
-		// current issue, i.e the jmp, we must not flush if issue_ar
-		// is set.
-		flush = {fs[1].v & !issue_ar, fs[0].v};
+		// That means every valid slot, except the one taking the
+		// current issue, i.e the jmp target.
+		for (i = 0; i < DEPTH; i++) begin
+			flush[i] = fs[i].v && !(issue_ar && issue_slot[i]);
+		end
 	end
 end
 
@@ -118,6 +115,10 @@ always_comb begin
 	if (issue_ar) begin
 		n_arvalid = 1;
 		n_araddr = pcgen_if.pc;
+`ifdef RVEE_CONFIG_C
+		// Jumps to pc + 2 fetch the whole word.
+		n_araddr[1] = 0;
+`endif
 	end else if (axi_fetch_if.ardone) begin
 		n_arvalid = 0;
 	end
@@ -125,33 +126,35 @@ end
 
 always_ff @(posedge clk) begin
 	pcgen_if.ready_ff <= pcgen_if.ready;
-	fs_ff[0].v <= fs[0].v;
-	fs_ff[1].v <= fs[1].v;
-	fs_ff[0].pc <= fs[0].pc;
-	fs_ff[1].pc <= fs[1].pc;
+	for (i = 0; i < DEPTH; i++) begin
+		fs_ff[i] <= fs[i];
+	end
 	flush_ff <= flush;
 
 	axi_fetch_if.arvalid <= n_arvalid;
 	axi_fetch_if.araddr <= n_araddr;
 
+	// Anything completing while we jump was issued before the jump.
 	if (axi_fetch_if.rdone) begin
-		fetch_if.valid <= !(flush[0] | flush_ff[0]);
+		fetch_if.valid <= !(pcgen_if.jmp_out | flush_ff[0]);
 		fetch_if.iw <= axi_fetch_if.rdata;
 		fetch_if.pc <= fs_ff[0].pc;
+		fetch_if.pred <= fs_ff[0].pred;
 	end else if (fetch_if.done) begin
 		fetch_if.valid <= 0;
 	end
 
 	if (rst) begin
 		axi_fetch_if.arvalid <= 0;
-		fs_ff[0].v <= 0;
-		fs_ff[1].v <= 0;
-		fs_ff[0].pc <= {XLEN{1'bx}};
-		fs_ff[1].pc <= {XLEN{1'bx}};
+		for (i = 0; i < DEPTH; i++) begin
+			fs_ff[i].v <= 0;
+			fs_ff[i].pc <= {XLEN{1'bx}};
+		end
 
 		fetch_if.valid <= 0;
 		fetch_if.iw <= 0;
 		fetch_if.pc <= 0;
+		fetch_if.pred <= 0;
 
 		pcgen_if.ready_ff <= 0;
 		flush_ff <= 0;
@@ -171,7 +174,7 @@ always_ff @(posedge clk) begin
 	end
 	if (axi_fetch_if.rdone) begin
 		$display("FT: rdone: fetched pc %x flush=%d",
-			fs_ff[0].pc, flush[0] | flush_ff[0]);
+			fs_ff[0].pc, pcgen_if.jmp_out | flush_ff[0]);
 	end
 `endif
 `ifdef DEBUG_FETCH_JMP
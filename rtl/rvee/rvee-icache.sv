@@ -0,0 +1,189 @@
+/*
+ * RVee instruction cache.
+ *
+ * Sits between the fetch unit and the fetch AXI port. Towards fetch it
+ * looks like an AXI-Lite target that returns hits the cycle after the
+ * AR handshake. Misses refill the whole line with back-to-back reads
+ * (one AR per word, all outstanding) on the fetch port and respond
+ * once the line is in.
+ *
+ * Direct-mapped or 2-way set associative, see rvee-config.svh.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* verilator lint_off DECLFILENAME */
+`include "include/axi.svh"
+`include "rvee/rvee-config.svh"
+
+module rvee_icache #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
+	input clk,
+	input rst,
+	input inval,		// FENCE.I, drop all lines.
+	output ev_hit,
+	output ev_miss,
+	axi4lite_if.target_port s_if,	// From fetch.
+	axi4lite_if.master_port m_if);	// To memory.
+
+	localparam WAYS = `RVEE_CONFIG_ICACHE_WAYS;
+	localparam SET_BITS = `RVEE_CONFIG_ICACHE_SET_BITS;
+	localparam LINE_BITS = `RVEE_CONFIG_ICACHE_LINE_BITS;
+	localparam SETS = 1 << SET_BITS;
+	localparam WORDS = 1 << LINE_BITS;
+	localparam TAG_LSB = 2 + LINE_BITS + SET_BITS;
+
+	// Ways are laid out one after the other, i.e index way * SETS + set.
+	logic	v[WAYS * SETS];
+	logic	[AWIDTH - 1:TAG_LSB] tag[WAYS * SETS];
+	logic	[DWIDTH - 1:0] data[WAYS * SETS * WORDS];
+	// Next way to replace in a set (2-way only).
+	logic	lru[SETS];
+
+	/* Fetch never writes.  */
+	assign	s_if.awready = 0;
+	assign	s_if.wready = 0;
+	assign	s_if.bvalid = 0;
+	assign	s_if.bresp = 0;
+
+	assign	m_if.awvalid = 0;
+	assign	m_if.awaddr = 0;
+	assign	m_if.awprot = 0;
+	assign	m_if.wvalid = 0;
+	assign	m_if.wdata = 0;
+	assign	m_if.wstrb = 0;
+	assign	m_if.bready = 1;
+	assign	m_if.arprot = 0;
+
+	// Line refill.
+	logic	refill;
+	logic	refill_err;
+	logic	refill_inval;
+	logic	[AWIDTH - 1:0] refill_addr;
+	logic	refill_way;
+	logic	[LINE_BITS:0] ar_cnt;
+	logic	[LINE_BITS - 1:0] r_cnt;
+	logic	[DWIDTH - 1:0] crit_data;
+	logic	[1:0] crit_resp;
+
+	wire	[SET_BITS - 1:0] set = s_if.araddr[TAG_LSB - 1:2 + LINE_BITS];
+	wire	[SET_BITS - 1:0] refill_set = refill_addr[TAG_LSB - 1:2 + LINE_BITS];
+	wire	[LINE_BITS - 1:0] crit_word = refill_addr[2 + LINE_BITS - 1:2];
+	wire	last_beat = m_if.rdone && r_cnt == WORDS - 1;
+
+	logic	hit;
+	logic	hit_way;
+	logic	[DWIDTH - 1:0] hit_data;
+
+	integer w;
+	always_comb begin
+		hit = 0;
+		hit_way = 0;
+		hit_data = data[s_if.araddr[TAG_LSB - 1:2]];
+		for (w = 0; w < WAYS; w++) begin
+			if (v[w * SETS + set] &&
+			    tag[w * SETS + set] == s_if.araddr[AWIDTH - 1:TAG_LSB]) begin
+				hit = 1;
+				hit_way = w[0];
+				hit_data = data[w * SETS * WORDS + s_if.araddr[TAG_LSB - 1:2]];
+			end
+		end
+	end
+
+	// One request at a time. Hits can be back-to-back.
+	assign	s_if.arready = !refill && s_if.ridle;
+	assign	m_if.rready = refill;
+	assign	ev_hit = s_if.ardone && hit;
+	assign	ev_miss = s_if.ardone && !hit;
+
+	wire	victim = WAYS > 1 ? lru[set] : 0;
+	wire	[LINE_BITS - 1:0] ar_word = ar_cnt[LINE_BITS - 1:0];
+
+	integer i;
+	always_ff @(posedge clk) begin
+		if (s_if.rdone) begin
+			s_if.rvalid <= 0;
+		end
+
+		if (s_if.ardone) begin
+			if (hit) begin
+				s_if.rvalid <= 1;
+				s_if.rdata <= hit_data;
+				s_if.rresp <= 0;
+				lru[set] <= !hit_way;
+			end else begin
+				refill <= 1;
+				refill_err <= 0;
+				refill_inval <= 0;
+				refill_addr <= s_if.araddr;
+				refill_way <= victim;
+				ar_cnt <= 0;
+				r_cnt <= 0;
+				v[victim * SETS + set] <= 0;
+				lru[set] <= !victim;
+			end
+		end
+
+		// Issue the line reads back-to-back.
+		if (m_if.ardone) begin
+			m_if.arvalid <= 0;
+		end
+		if (refill && ar_cnt < WORDS && m_if.aridle) begin
+			m_if.arvalid <= 1;
+			m_if.araddr <= {refill_addr[AWIDTH - 1:2 + LINE_BITS],
+					ar_word, 2'b00};
+			ar_cnt <= ar_cnt + 1;
+		end
+
+		if (m_if.rdone) begin
+			data[refill_way * SETS * WORDS + {refill_set, r_cnt}] <= m_if.rdata;
+			if (r_cnt == crit_word) begin
+				crit_data <= m_if.rdata;
+				crit_resp <= m_if.rresp;
+			end
+			if (m_if.rresp != 0) begin
+				refill_err <= 1;
+			end
+			r_cnt <= r_cnt + 1;
+		end
+
+		if (last_beat) begin
+			refill <= 0;
+			v[refill_way * SETS + refill_set] <= !refill_err &&
+				m_if.rresp == 0 && !refill_inval;
+			tag[refill_way * SETS + refill_set] <= refill_addr[AWIDTH - 1:TAG_LSB];
+
+			s_if.rvalid <= 1;
+			s_if.rdata <= crit_data;
+			s_if.rresp <= crit_resp;
+			if (r_cnt == crit_word) begin
+				s_if.rdata <= m_if.rdata;
+				s_if.rresp <= m_if.rresp;
+			end
+		end
+
+		if (inval || rst) begin
+			refill_inval <= 1;
+			for (i = 0; i < WAYS * SETS; i++) begin
+				v[i] <= 0;
+			end
+		end
+
+		if (rst) begin
+			refill <= 0;
+			s_if.rvalid <= 0;
+			m_if.arvalid <= 0;
+			for (i = 0; i < SETS; i++) begin
+				lru[i] <= 0;
+			end
+		end
+`ifdef DEBUG_ICACHE
+		if (s_if.ardone) begin
+			$display("IC: %x %s way=%d", s_if.araddr,
+				hit ? "hit" : "miss", hit ? hit_way : victim);
+		end
+`endif
+	end
+endmodule
@@ -16,6 +16,7 @@
 `include "rvee/rvee-mem.svh"
 `include "rvee/rvee-csr-regs.vh"
 `include "rvee/rvee-rf.svh"
+`include "rvee/rvee-commit.svh"
 
 module rvee_mem #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
 	input clk,
@@ -23,6 +24,9 @@ module rvee_mem #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
 	axi4lite_if.master_port axi_mem_if,
 	rvee_rf_if.mem_port rf_if,
 	rvee_exec_if.mem_port exec_if,
+`ifdef RVEE_CONFIG_COMMIT_PORT
+	`RVEE_COMMIT_PORT(XLEN),
+`endif
 	rvee_mem_if.mem_port mem_if);
 
 	integer exec_if_mem_size = exec_if.mem_size;
@@ -41,6 +45,30 @@ module rvee_mem #(parameter XLEN=32, AWIDTH=32, DWIDTH=32) (
 	logic	axi_pending;
 	logic	n_axi_pending;
 
+	// Store buffer, see RVEE_CONFIG_STORE_BUF.
+	logic	sb_stall;	// Can't take this access yet.
+	logic	sb_fwd;		// Load bytes are all in the buffer.
+	logic	[XLEN - 1:0] sb_fwd_data;
+	logic	sb_push;	// Store retires into the buffer.
+	logic	ld_fwd;		// Load completes with forwarded data.
+`ifdef RVEE_CONFIG_STORE_BUF
+	// Only loads wait for the AXI port, B responses drain the buffer.
+	wire	ax_done = axi_mem_if.rdone;
+`else
+	wire	ax_done = axi_mem_if.rdone || axi_mem_if.bdone;
+`endif
+	wire	ld_done = axi_mem_if.rdone || ld_fwd;
+
+`ifdef RVEE_DPI_RETIRE
+	// Simulation only. Reports every insn that leaves the pipe, with
+	// the register write it's about to do, to a C++ checker.
+	// mem_trap is set for insns that fault here instead of retiring,
+	// trap_entry for the bubbles that carry trap entries.
+	import "DPI-C" function void rvee_dpi_retire(input int pc,
+		input bit rd_we, input int rd, input int rd_data,
+		input bit mem_trap, input bit trap_entry);
+`endif
+
 always_comb begin
 	// Register forwarding.
 	rf_if.wb_we = mem_if.rd_we;
@@ -54,9 +82,10 @@ always_comb begin
 
 	if (exec_if.valid) begin
 		if (axi_pending) begin
-			exec_if.ready = axi_mem_if.rdone | axi_mem_if.bdone;
+			exec_if.ready = ax_done;
 		end else begin
-			exec_if.ready = !(exec_if.mem_load | exec_if.mem_store) || mem_if.exception;
+			exec_if.ready = !(exec_if.mem_load | exec_if.mem_store) ||
+				mem_if.exception || sb_push || ld_fwd;
 		end
 	end
 
@@ -96,10 +125,104 @@ always_comb begin
 	endcase
 end
 
+`ifdef RVEE_CONFIG_STORE_BUF
+	// Store buffer. A FIFO of writes that drain in order on the AW/W
+	// channels. Entries stay until their B response is back so that
+	// loads can't pass an in-flight write to the same word.
+	localparam SB_DEPTH = `RVEE_CONFIG_STORE_BUF_DEPTH;
+	localparam SB_BITS = $clog2(SB_DEPTH);
+
+	logic	[AWIDTH - 1:0] sb_addr[SB_DEPTH];
+	logic	[DWIDTH - 1:0] sb_data[SB_DEPTH];
+	logic	[3:0] sb_strb[SB_DEPTH];
+	// Oldest entry (waiting for B), next entry to send on AW and on W,
+	// and next free entry. The extra MSB tells full from empty.
+	logic	[SB_BITS:0] sb_head, sb_aw, sb_w, sb_tail;
+
+	wire	[SB_BITS:0] sb_count = sb_tail - sb_head;
+	wire	sb_full = sb_count == SB_DEPTH;
+	assign	mem_if.sb_empty = sb_count == 0;
+
+	assign	axi_mem_if.awvalid = sb_aw != sb_tail;
+	assign	axi_mem_if.awaddr = sb_addr[sb_aw[SB_BITS - 1:0]];
+	assign	axi_mem_if.wvalid = sb_w != sb_tail;
+	assign	axi_mem_if.wdata = sb_data[sb_w[SB_BITS - 1:0]];
+	assign	axi_mem_if.wstrb = sb_strb[sb_w[SB_BITS - 1:0]];
+
+	logic	sb_hit;
+	logic	[3:0] sb_fwd_strb;
+	logic	[SB_BITS:0] sb_idx;
+	integer i, b;
+always_comb begin
+	// Merge the buffered bytes of this word, oldest to youngest
+	// so that younger stores win.
+	sb_fwd_strb = 0;
+	sb_fwd_data = 0;
+	for (i = 0; i < SB_DEPTH; i++) begin
+		sb_idx = sb_head + i[SB_BITS:0];
+		if (i < sb_count &&
+		    sb_addr[sb_idx[SB_BITS - 1:0]][AWIDTH - 1:2] == ea[AWIDTH - 1:2]) begin
+			for (b = 0; b < 4; b++) begin
+				if (sb_strb[sb_idx[SB_BITS - 1:0]][b]) begin
+					sb_fwd_data[b * 8 +: 8] = sb_data[sb_idx[SB_BITS - 1:0]][b * 8 +: 8];
+				end
+			end
+			sb_fwd_strb = sb_fwd_strb | sb_strb[sb_idx[SB_BITS - 1:0]];
+		end
+	end
+	sb_hit = (sb_fwd_strb & wstrb) != 0;
+	sb_fwd = sb_hit && (sb_fwd_strb & wstrb) == wstrb;
+
+	sb_stall = 0;
+	if (exec_if.mem_store && sb_full) begin
+		sb_stall = 1;
+	end
+	if (exec_if.mem_load) begin
+		// Partial overlap, wait for the store to reach memory.
+		if (sb_hit && !sb_fwd) begin
+			sb_stall = 1;
+		end
+		if (ea >= `RVEE_CONFIG_IO_BASE && !mem_if.sb_empty) begin
+			sb_stall = 1;
+		end
+	end
+end
+
+always_ff @(posedge clk) begin
+	if (sb_push) begin
+		sb_addr[sb_tail[SB_BITS - 1:0]] <= ea;
+		sb_data[sb_tail[SB_BITS - 1:0]] <= wdata;
+		sb_strb[sb_tail[SB_BITS - 1:0]] <= wstrb;
+		sb_tail <= sb_tail + 1;
+	end
+	if (axi_mem_if.awdone) begin
+		sb_aw <= sb_aw + 1;
+	end
+	if (axi_mem_if.wdone) begin
+		sb_w <= sb_w + 1;
+	end
+	if (axi_mem_if.bdone) begin
+		sb_head <= sb_head + 1;
+	end
+
+	if (rst) begin
+		sb_head <= 0;
+		sb_aw <= 0;
+		sb_w <= 0;
+		sb_tail <= 0;
+	end
+end
+`else
+	assign	sb_stall = 0;
+	assign	sb_fwd = 0;
+	assign	sb_fwd_data = 0;
+	assign	mem_if.sb_empty = 1;
+`endif
+
 // Compute rdata
 	logic	[XLEN - 1:0] rdata;
 always_comb begin
-	rdata = axi_mem_if.rdata;
+	rdata = ld_fwd ? sb_fwd_data : axi_mem_if.rdata;
 	case (ea[1:0])
 	0: rdata = rdata;
 	1: rdata = {8'dx, rdata[XLEN - 1:8]};
@@ -114,6 +237,13 @@ always_comb begin
 	endcase
 end
 
+// Load data forwarding, as it arrives.
+always_comb begin
+	rf_if.ld_we = ld_done;
+	rf_if.ld_rd = exec_if.rd;
+	rf_if.ld_data = rdata;
+end
+
 // We can handle some unaligned accesses, but not all.
 	logic	addr_unaligned;
 always_comb begin
@@ -128,11 +258,11 @@ end
 	logic	issue_ax;
 always_comb begin
 	n_axi_pending = axi_pending;
-	if (axi_mem_if.rdone || axi_mem_if.bdone) begin
+	if (ax_done) begin
 		n_axi_pending = 0;
 	end
 
-	issue_ax = !axi_pending;
+	issue_ax = !axi_pending && !sb_stall;
 	if (exec_if.valid && issue_ax) begin
 		n_axi_pending = exec_if.mem_load | exec_if.mem_store;
 	end
@@ -165,17 +295,49 @@ always_comb begin
 		end
 	end
 `endif
+
+	// Buffered stores and forwarded loads are done right away.
+`ifdef RVEE_CONFIG_STORE_BUF
+	sb_push = exec_if.valid && issue_ax && exec_if.mem_store;
+`else
+	sb_push = 0;
+`endif
+	ld_fwd = exec_if.valid && issue_ax && exec_if.mem_load && sb_fwd;
+	if (sb_push || ld_fwd) begin
+		n_axi_pending = 0;
+	end
 end
 
+`ifdef RVEE_CONFIG_COMMIT_PORT
+always_comb begin
+	commit_valid = exec_if.done && !rst;
+	commit_pc = exec_if.pc;
+	commit_iw = exec_if.iw;
+	commit_rd_we = ld_done || (exec_if.rd_we && !mem_if.exception);
+	commit_rd = exec_if.rd;
+	commit_wdata = ld_done ? rdata : exec_if.result;
+	if (exec_if.mem_store) begin
+		commit_wdata = exec_if.mem_data;
+	end
+	commit_mem_load = exec_if.mem_load;
+	commit_mem_store = exec_if.mem_store;
+	commit_mem_addr = ea;
+	commit_trap = mem_if.exception;
+	commit_trap_entry = exec_if.trap;
+end
+`endif
+
 always_ff @(posedge clk) begin
 	mem_if.rd_we <= exec_if.rd_we && !mem_if.exception;
 	mem_if.rd <= exec_if.rd;
 	mem_if.rd_data <= exec_if.result;
 
 	axi_mem_if.araddr <= ea;
+`ifndef RVEE_CONFIG_STORE_BUF
 	axi_mem_if.awaddr <= ea;
 	axi_mem_if.wdata <= wdata;
 	axi_mem_if.wstrb <= wstrb;
+`endif
 	axi_mem_if.rready <= 1;
 	axi_mem_if.bready <= 1;
 	axi_pending <= n_axi_pending;
@@ -183,31 +345,47 @@ always_ff @(posedge clk) begin
 	if (axi_mem_if.ardone) begin
 		axi_mem_if.arvalid <= 0;
 	end
+`ifndef RVEE_CONFIG_STORE_BUF
 	if (axi_mem_if.awdone) begin
 		axi_mem_if.awvalid <= 0;
 	end
 	if (axi_mem_if.wdone) begin
 		axi_mem_if.wvalid <= 0;
 	end
-	if (axi_mem_if.rdone) begin
+`endif
+	if (ld_done) begin
 		mem_if.rd_we <= 1;
 		mem_if.rd_data <= rdata;
 	end
 
 	if (exec_if.valid & issue_ax) begin
-		axi_mem_if.arvalid <= exec_if.mem_load;
+		axi_mem_if.arvalid <= exec_if.mem_load && !ld_fwd;
+`ifndef RVEE_CONFIG_STORE_BUF
 		axi_mem_if.awvalid <= exec_if.mem_store;
 		axi_mem_if.wvalid <= exec_if.mem_store;
+`endif
 	end
 
 	if (rst) begin
 		axi_mem_if.arvalid <= 0;
+`ifndef RVEE_CONFIG_STORE_BUF
 		axi_mem_if.awvalid <= 0;
 		axi_mem_if.wvalid <= 0;
+`endif
 		mem_if.rd_we <= 0;
 		axi_pending <= 0;
 	end
 
+`ifdef RVEE_DPI_RETIRE
+	if (exec_if.done && !rst) begin
+		rvee_dpi_retire(exec_if.pc,
+			ld_done || (exec_if.rd_we && !mem_if.exception),
+			{27'b0, exec_if.rd},
+			ld_done ? rdata : exec_if.result,
+			mem_if.exception, exec_if.trap);
+	end
+`endif
+
 `ifdef DEBUG_MEM_LD
 	if (axi_mem_if.rdone) begin
 		$display("MEM: loaded m[%x]=%x %x mem_size=%d\n",
@@ -0,0 +1,114 @@
+/*
+ * RVee RV32M multiply/divide unit.
+ *
+ * Multiplies are combinational, a 33x33 signed multiply that maps
+ * onto DSP blocks. Divides and remainders run on an iterative
+ * restoring divider on the operand magnitudes that retires
+ * RVEE_CONFIG_DIV_STEPS quotient bits per cycle.
+ *
+ * op is funct3 of the M insn. The unit watches the insn waiting in
+ * decode_if (valid) and raises ready once d holds its result.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* verilator lint_off DECLFILENAME */
+`include "rvee/rvee-config.svh"
+
+module rvee_muldiv #(parameter XLEN=32) (
+	input clk,
+	input rst,
+	input valid,		// An M insn is waiting.
+	input done,		// It leaves (or gets dropped) this cycle.
+	input [2:0] op,
+	input [XLEN - 1:0] a,
+	input [XLEN - 1:0] b,
+	output logic ready,
+	output logic [XLEN - 1:0] d);
+
+	localparam STEPS = `RVEE_CONFIG_DIV_STEPS;
+
+	// MUL, MULH, MULHSU and MULHU.
+	wire	a_signed = op[1:0] != 2'b11;
+	wire	b_signed = op[1] == 0;
+	logic	signed [2 * XLEN + 1:0] mul_d;
+	assign	mul_d = $signed({a_signed & a[XLEN - 1], a}) *
+			$signed({b_signed & b[XLEN - 1], b});
+
+	// DIV, DIVU, REM and REMU.
+	wire	div_signed = !op[0];
+	wire	a_neg = div_signed && a[XLEN - 1];
+	wire	b_neg = div_signed && b[XLEN - 1];
+
+	logic	div_busy;
+	logic	div_done;
+	logic	[$clog2(XLEN):0] div_cnt;
+	// The dividend shifts out of q as the quotient shifts in.
+	logic	[XLEN - 1:0] div_q;
+	logic	[XLEN - 1:0] div_r;
+	logic	[XLEN - 1:0] div_b;
+	logic	neg_q;
+	logic	neg_r;
+
+	logic	[XLEN - 1:0] n_q;
+	logic	[XLEN - 1:0] n_r;
+	logic	[XLEN:0] r_shift;
+	integer	s;
+	always_comb begin
+		n_q = div_q;
+		n_r = div_r;
+		for (s = 0; s < STEPS; s++) begin
+			r_shift = {n_r, n_q[XLEN - 1]};
+			n_q = {n_q[XLEN - 2:0], 1'b0};
+			if (r_shift >= {1'b0, div_b}) begin
+				r_shift = r_shift - {1'b0, div_b};
+				n_q[0] = 1;
+			end
+			n_r = r_shift[XLEN - 1:0];
+		end
+	end
+
+	always_comb begin
+		ready = !op[2] || div_done;
+		d = op[1:0] == 2'b00 ? mul_d[XLEN - 1:0] : mul_d[2 * XLEN - 1:XLEN];
+		if (op[2]) begin
+			if (op[1]) begin
+				d = neg_r ? -div_r : div_r;
+			end else begin
+				d = neg_q ? -div_q : div_q;
+			end
+		end
+	end
+
+	always_ff @(posedge clk) begin
+		if (div_busy) begin
+			div_q <= n_q;
+			div_r <= n_r;
+			div_cnt <= div_cnt - STEPS;
+			if (div_cnt == STEPS) begin
+				div_busy <= 0;
+				div_done <= 1;
+			end
+		end
+
+		if (valid && op[2] && !div_busy && !div_done) begin
+			div_busy <= 1;
+			div_cnt <= XLEN;
+			div_q <= a_neg ? -a : a;
+			div_r <= 0;
+			div_b <= b_neg ? -b : b;
+			// x / 0 is all ones and x % 0 is x, both fall out of
+			// the unsigned divide as long as q isn't negated.
+			neg_q <= (a_neg ^ b_neg) && b != 0;
+			neg_r <= a_neg;
+		end
+
+		if (done || rst) begin
+			div_busy <= 0;
+			div_done <= 0;
+		end
+	end
+endmodule
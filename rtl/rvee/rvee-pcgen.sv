@@ -8,6 +8,7 @@
  */
 
 /* verilator lint_off DECLFILENAME */
+`include "rvee/rvee-config.svh"
 `include "rvee/rvee-pcgen.svh"
 
 module rvee_pcgen #(parameter XLEN=32) (
@@ -18,6 +19,25 @@ module rvee_pcgen #(parameter XLEN=32) (
 
 	logic	[XLEN - 1:0] jmp_base_ff;
 	logic	[XLEN - 1:0] jmp_offset_ff;
+	logic	pjmp_ff;
+	logic	[XLEN - 1:0] pjmp_base_ff;
+	logic	[XLEN - 1:0] pjmp_offset_ff;
+
+	// Branch target buffer and branch history table.
+	// Only used with RVEE_CONFIG_BPRED 2.
+	localparam BTB_BITS = `RVEE_CONFIG_BPRED_BTB_BITS;
+	localparam BHT_BITS = `RVEE_CONFIG_BPRED_BHT_BITS;
+	logic	btb_v[1 << BTB_BITS];
+	logic	btb_jal[1 << BTB_BITS];
+	logic	[XLEN - 1:2] btb_tag[1 << BTB_BITS];
+	logic	[XLEN - 1:0] btb_target[1 << BTB_BITS];
+	logic	[1:0] bht[1 << BHT_BITS];
+
+	logic	[BTB_BITS - 1:0] btb_idx;
+	logic	[BHT_BITS - 1:0] bht_idx;
+	logic	pred_ff;
+	logic	[XLEN - 1:0] pred_target_ff;
+	logic	bp_inval_ff;
 
 	logic	[XLEN - 1:0] a;
 	logic	[XLEN - 1:0] b;
@@ -36,18 +56,102 @@ always_comb begin
 	//
 	// jmp and bcc have no back-pressure. They are presented for a
 	// single cycle.
+	//
+	// pjmp comes from DECODE for predicted taken branches and is
+	// flopped the same way. It is younger than anything in EX so
+	// jmp_ff and bcc take priority. DECODE drops insns while EX
+	// jumps, so pjmp and jmp never arrive in the same cycle.
+	//
+	// If the last issued pc hit in the BTB (pred_ff), we continue
+	// at the predicted target instead of pc + 4.
 	// 
 	a = pcgen_if.pc_ff;
 	b = pcgen_if.ready_ff ? 4 : 0;
+`ifdef RVEE_CONFIG_C
+	// Fetch goes by words. After a jump into the upper half of a
+	// word, the next one starts at the word boundary.
+	if (pcgen_if.ready_ff) begin
+		a[1] = 0;
+	end
+`endif
+	if (pcgen_if.ready_ff && pred_ff) begin
+		a = pred_target_ff;
+		b = 0;
+	end
 	// bcc is combinatonal and arrives one cycle late.
-	pcgen_if.jmp_out = pcgen_if.jmp_ff | pcgen_if.bcc;
+	pcgen_if.jmp_out = pcgen_if.jmp_ff | pcgen_if.bcc | pjmp_ff;
 	if (pcgen_if.jmp_out) begin
 		a = jmp_base_ff;
 		b = jmp_offset_ff;
+		if (!pcgen_if.jmp_ff && !pcgen_if.bcc) begin
+			a = pjmp_base_ff;
+			b = pjmp_offset_ff;
+		end
 	end
 
 	d = a + b;
 	pcgen_if.pc = {d[XLEN - 1:1], 1'b0};
+
+	// BTB lookup for the pc we're presenting. FETCH carries the
+	// prediction along with the insn so DECODE can check it.
+	btb_idx = pcgen_if.pc[BTB_BITS + 1:2];
+	bht_idx = pcgen_if.pc[BHT_BITS + 1:2];
+	pcgen_if.pred = `RVEE_CONFIG_BPRED >= 2 && btb_v[btb_idx] &&
+			btb_tag[btb_idx] == pcgen_if.pc[XLEN - 1:2] &&
+			(btb_jal[btb_idx] || bht[bht_idx][1]);
+`ifdef RVEE_CONFIG_C
+	// The BTB tracks words and can't tell which of the insns in a
+	// word it predicted. Leave it to BTFN in DECODE.
+	pcgen_if.pred = 0;
+`endif
+end
+
+	wire	[BTB_BITS - 1:0] bp_btb_idx = pcgen_if.bp_pc[BTB_BITS + 1:2];
+	wire	[BHT_BITS - 1:0] bp_bht_idx = pcgen_if.bp_pc[BHT_BITS + 1:2];
+	integer i;
+always_ff @(posedge clk) begin
+	pred_ff <= pcgen_if.pred;
+	pred_target_ff <= btb_target[btb_idx];
+
+	// Train on resolved branches and JALs.
+	if (pcgen_if.bp_we) begin
+		if (pcgen_if.bp_taken && bht[bp_bht_idx] != 2'b11) begin
+			bht[bp_bht_idx] <= bht[bp_bht_idx] + 2'd1;
+		end
+		if (!pcgen_if.bp_taken && bht[bp_bht_idx] != 2'b00) begin
+			bht[bp_bht_idx] <= bht[bp_bht_idx] - 2'd1;
+		end
+
+		if (pcgen_if.bp_taken) begin
+			btb_v[bp_btb_idx] <= 1;
+			btb_jal[bp_btb_idx] <= pcgen_if.bp_jal;
+			btb_tag[bp_btb_idx] <= pcgen_if.bp_pc[XLEN - 1:2];
+			btb_target[bp_btb_idx] <= pcgen_if.bp_target;
+		end
+	end
+
+	// After FENCE.I the BTB may point into code that has since been
+	// rewritten and DECODE trusts BTB targets, so drop them all.
+	// Branches older than the FENCE.I train a cycle late, keep
+	// clearing for one more cycle so they don't sneak back in.
+	bp_inval_ff <= pcgen_if.bp_inval;
+	if (pcgen_if.bp_inval || bp_inval_ff) begin
+		for (i = 0; i < (1 << BTB_BITS); i++) begin
+			btb_v[i] <= 0;
+		end
+	end
+
+	if (rst || `RVEE_CONFIG_BPRED < 2) begin
+		pred_ff <= 0;
+		bp_inval_ff <= 0;
+		for (i = 0; i < (1 << BTB_BITS); i++) begin
+			btb_v[i] <= 0;
+		end
+		// Weakly not-taken.
+		for (i = 0; i < (1 << BHT_BITS); i++) begin
+			bht[i] <= 2'b01;
+		end
+	end
 end
 
 always_ff @(posedge clk) begin
@@ -55,6 +159,9 @@ always_ff @(posedge clk) begin
 	pcgen_if.jmp_ff <= pcgen_if.jmp;
 	jmp_base_ff <= pcgen_if.jmp_base;
 	jmp_offset_ff <= pcgen_if.jmp_offset;
+	pjmp_ff <= pcgen_if.pjmp;
+	pjmp_base_ff <= pcgen_if.pjmp_base;
+	pjmp_offset_ff <= pcgen_if.pjmp_offset;
 
 	if (pcgen_if.ready_ff | pcgen_if.jmp_out) begin
 		pcgen_if.pc_ff <= pcgen_if.pc;
@@ -64,11 +171,13 @@ always_ff @(posedge clk) begin
 		pcgen_if.valid <= 0;
 		pcgen_if.pc_ff <= {resetv[XLEN - 1:1], 1'b0};
 		pcgen_if.jmp_ff <= 0;
+		pjmp_ff <= 0;
 	end
 `ifdef DEBUG_PCGEN
-	$display("PG: pc=%x r=%d jmp=%d.%d.%d bcc=%d",
+	$display("PG: pc=%x r=%d jmp=%d.%d.%d bcc=%d pjmp=%d.%d pred=%d.%d",
 		pcgen_if.pc, pcgen_if.ready,
-		pcgen_if.jmp, pcgen_if.jmp_ff, pcgen_if.jmp_out, pcgen_if.bcc);
+		pcgen_if.jmp, pcgen_if.jmp_ff, pcgen_if.jmp_out, pcgen_if.bcc,
+		pcgen_if.pjmp, pjmp_ff, pcgen_if.pred, pred_ff);
 `endif
 end
 endmodule
@@ -19,6 +19,16 @@ module rvee_rf_ff #(parameter XLEN=32, N_REGS=32) (
 
 	logic [XLEN - 1:0] R [N_REGS];
 
+`ifdef RVEE_DPI_BACKDOOR
+	// Simulation only. While in reset, registers the testbench has a
+	// value for are loaded with it, e.g after fast-forwarding on the
+	// ISS.
+	import "DPI-C" function bit rvee_dpi_backdoor_rf(input int r,
+							 output int v);
+	int bd_v;
+	integer bd_i;
+`endif
+
 `define REGFW(valid, rd, rd_data, rs, rs_data)	\
 	if (valid && rd == rs) begin		\
 		rs_data = rd_data;		\
@@ -37,6 +47,11 @@ always_comb begin
 		`REGFW(rf_if.mem_we, rf_if.mem_rd, rf_if.mem_data, rf_if.rs2, rf_if.rs2_data);
 	end
 
+`ifdef RVEE_CONFIG_LOAD_REGFW
+	`REGFW(rf_if.ld_we, rf_if.ld_rd, rf_if.ld_data, rf_if.rs1, rf_if.rs1_data);
+	`REGFW(rf_if.ld_we, rf_if.ld_rd, rf_if.ld_data, rf_if.rs2, rf_if.rs2_data);
+`endif
+
 	// Register x0.
 	`REGFW(1, 0, 0, rf_if.rs1, rf_if.rs1_data);
 	`REGFW(1, 0, 0, rf_if.rs2, rf_if.rs2_data);
@@ -53,5 +68,14 @@ always_ff @(posedge clk) begin
 	if (rf_if.wb_we) begin
 		R[rf_if.wb_rd] <= rf_if.wb_data;
 	end
+`ifdef RVEE_DPI_BACKDOOR
+	if (rst) begin
+		for (bd_i = 1; bd_i < N_REGS; bd_i++) begin
+			if (rvee_dpi_backdoor_rf(bd_i, bd_v)) begin
+				R[bd_i] <= bd_v;
+			end
+		end
+	end
+`endif
 end
 endmodule
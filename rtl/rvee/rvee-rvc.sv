@@ -0,0 +1,248 @@
+/*
+ * RVee RV32C aligner and expander.
+ *
+ * Sits between fetch and decode. Fetch returns aligned 32-bit words,
+ * starting at the upper half after a jump to pc + 2. This unit cuts
+ * them into insns, one per cycle: 16-bit insns are expanded into the
+ * 32-bit insns they stand for and flagged with rvc so that decode
+ * links and falls through to pc + 2. 32-bit insns that straddle two
+ * words wait for the second one with their lower half held in lo.
+ *
+ * Redirects drop whole words, the same way decode drops insns.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* verilator lint_off DECLFILENAME */
+`include "rvee/rvee-config.svh"
+`include "rvee/rvee-pcgen.svh"
+`include "rvee/rvee-fetch.svh"
+
+module rvee_rvc #(parameter XLEN=32) (
+	input clk,
+	input rst,
+	rvee_pcgen_if.align_port pcgen_if,
+	rvee_fetch_if.decode_port in_if,	// Words from fetch.
+	rvee_fetch_if.fetch_port out_if);	// Insns to decode.
+
+	localparam [6:0] OP_LUI = 7'b0110111;
+	localparam [6:0] OP_JAL = 7'b1101111;
+	localparam [6:0] OP_JALR = 7'b1100111;
+	localparam [6:0] OP_BCC = 7'b1100011;
+	localparam [6:0] OP_LOAD = 7'b0000011;
+	localparam [6:0] OP_STORE = 7'b0100011;
+	localparam [6:0] OP_IMM = 7'b0010011;
+	localparam [6:0] OP_REG = 7'b0110011;
+
+	// Reserved and floating-point encodings expand to 0, which
+	// decode traps on as illegal.
+	function automatic [31:0] expand(input [15:0] c);
+		logic [4:0] rd;
+		logic [4:0] rs2;
+		logic [4:0] rdp;
+		logic [4:0] rs1p;
+		logic [11:0] imm6;
+		logic [11:0] uimm;
+		logic [20:0] joff;
+		logic [12:0] boff;
+		logic [11:0] addi16sp;
+
+		rd = c[11:7];
+		rs2 = c[6:2];
+		rdp = {2'b01, c[4:2]};
+		rs1p = {2'b01, c[9:7]};
+		imm6 = {{7{c[12]}}, c[6:2]};
+		joff = {{10{c[12]}}, c[8], c[10:9], c[6], c[7], c[2], c[11], c[5:3], 1'b0};
+		boff = {{5{c[12]}}, c[6:5], c[2], c[11:10], c[4:3], 1'b0};
+		addi16sp = {{3{c[12]}}, c[4:3], c[5], c[2], c[6], 4'b0000};
+
+		expand = 0;
+		case ({c[15:13], c[1:0]})
+		// Quadrant 0.
+		5'b000_00: begin
+			/* C.ADDI4SPN  */
+			uimm = {2'b00, c[10:7], c[12:11], c[5], c[6], 2'b00};
+			if (uimm != 0) begin
+				expand = {uimm, 5'd2, 3'b000, rdp, OP_IMM};
+			end
+		end
+		5'b010_00: begin
+			/* C.LW  */
+			uimm = {5'b0, c[5], c[12:10], c[6], 2'b00};
+			expand = {uimm, rs1p, 3'b010, rdp, OP_LOAD};
+		end
+		5'b110_00: begin
+			/* C.SW  */
+			uimm = {5'b0, c[5], c[12:10], c[6], 2'b00};
+			expand = {uimm[11:5], rdp, rs1p, 3'b010, uimm[4:0], OP_STORE};
+		end
+		// Quadrant 1.
+		5'b000_01: begin
+			/* C.ADDI, C.NOP  */
+			expand = {imm6, rd, 3'b000, rd, OP_IMM};
+		end
+		5'b001_01,
+		5'b101_01: begin
+			/* C.JAL, C.J  */
+			expand = {joff[20], joff[10:1], joff[11], joff[19:12],
+				  4'b0000, !c[15], OP_JAL};
+		end
+		5'b010_01: begin
+			/* C.LI  */
+			expand = {imm6, 5'd0, 3'b000, rd, OP_IMM};
+		end
+		5'b011_01: begin
+			if (rd == 2) begin
+				/* C.ADDI16SP  */
+				if (addi16sp != 0) begin
+					expand = {addi16sp, 5'd2, 3'b000, 5'd2, OP_IMM};
+				end
+			end else if (imm6 != 0) begin
+				/* C.LUI  */
+				expand = {{8{c[12]}}, imm6, rd, OP_LUI};
+			end
+		end
+		5'b100_01: begin
+			case (c[11:10])
+			2'b00,
+			2'b01: begin
+				/* C.SRLI, C.SRAI  */
+				if (!c[12]) begin
+					expand = {1'b0, c[10], 5'b0, rs2, rs1p, 3'b101,
+						  rs1p, OP_IMM};
+				end
+			end
+			2'b10: begin
+				/* C.ANDI  */
+				expand = {imm6, rs1p, 3'b111, rs1p, OP_IMM};
+			end
+			2'b11: begin
+				/* C.SUB, C.XOR, C.OR, C.AND  */
+				if (!c[12]) begin
+					expand = {1'b0, c[6:5] == 2'b00, 5'b0, rdp, rs1p,
+						  c[6:5] == 2'b00 ? 3'b000 :
+						  c[6:5] == 2'b01 ? 3'b100 :
+						  c[6:5] == 2'b10 ? 3'b110 : 3'b111,
+						  rs1p, OP_REG};
+				end
+			end
+			endcase
+		end
+		5'b110_01,
+		5'b111_01: begin
+			/* C.BEQZ, C.BNEZ  */
+			expand = {boff[12], boff[10:5], 5'd0, rs1p, 2'b00, c[13],
+				  boff[4:1], boff[11], OP_BCC};
+		end
+		// Quadrant 2.
+		5'b000_10: begin
+			/* C.SLLI  */
+			if (!c[12]) begin
+				expand = {7'b0, rs2, rd, 3'b001, rd, OP_IMM};
+			end
+		end
+		5'b010_10: begin
+			/* C.LWSP  */
+			uimm = {4'b0, c[3:2], c[12], c[6:4], 2'b00};
+			if (rd != 0) begin
+				expand = {uimm, 5'd2, 3'b010, rd, OP_LOAD};
+			end
+		end
+		5'b100_10: begin
+			if (rs2 == 0) begin
+				if (rd != 0) begin
+					/* C.JR, C.JALR  */
+					expand = {12'b0, rd, 3'b000, 4'b0000, c[12], OP_JALR};
+				end else if (c[12]) begin
+					/* C.EBREAK  */
+					expand = 32'h00100073;
+				end
+			end else begin
+				/* C.MV, C.ADD  */
+				expand = {7'b0, rs2, c[12] ? rd : 5'd0, 3'b000, rd, OP_REG};
+			end
+		end
+		5'b110_10: begin
+			/* C.SWSP  */
+			uimm = {4'b0, c[8:7], c[12:9], 2'b00};
+			expand = {uimm[11:5], rs2, 5'd2, 3'b010, uimm[4:0], OP_STORE};
+		end
+		default: begin end
+		endcase
+	endfunction
+
+	// Lower half of a 32-bit insn that straddles two words.
+	logic	lo_v;
+	logic	[15:0] lo;
+	logic	[XLEN - 1:0] lo_pc;
+	// The lower half of the current word has been used.
+	logic	mid;
+	logic	drop_ff;
+
+	// Mirrors decode's flush. Anything left of a word that decode
+	// drops an insn from is stale too.
+	wire	redirect = pcgen_if.jmp || pcgen_if.jmp_out;
+	wire	drop = redirect || drop_ff;
+
+	wire	half = in_if.pc[1] || mid;
+	wire	[15:0] hw = half ? in_if.iw[31:16] : in_if.iw[15:0];
+	wire	hw_rvc = hw[1:0] != 2'b11;
+	// A 32-bit insn starting in the upper half, hold on to it.
+	wire	stash = !lo_v && !hw_rvc && half;
+	// The current word is used up once this insn goes.
+	wire	last = !lo_v && (half || !hw_rvc);
+
+	assign	out_if.valid = in_if.valid && !stash;
+	assign	out_if.pred = in_if.pred;
+	assign	out_if.flush = in_if.flush;
+	assign	in_if.ready = stash || (out_if.ready && (last || drop));
+
+	always_comb begin
+		out_if.iw = expand(hw);
+		out_if.rvc = 1;
+		out_if.pc = {in_if.pc[XLEN - 1:2], half, 1'b0};
+		if (lo_v) begin
+			out_if.iw = {in_if.iw[15:0], lo};
+			out_if.rvc = 0;
+			out_if.pc = lo_pc;
+		end else if (!hw_rvc) begin
+			out_if.iw = in_if.iw;
+			out_if.rvc = 0;
+		end
+	end
+
+	always_ff @(posedge clk) begin
+		drop_ff <= redirect && !out_if.valid;
+
+		if (out_if.done) begin
+			lo_v <= 0;
+			mid <= 1;
+		end
+		if (in_if.done) begin
+			mid <= 0;
+			if (stash && !drop) begin
+				lo_v <= 1;
+				lo <= in_if.iw[31:16];
+				lo_pc <= {in_if.pc[XLEN - 1:2], 2'b10};
+			end
+		end
+		if (drop && !out_if.valid) begin
+			lo_v <= 0;
+		end
+
+		if (rst) begin
+			lo_v <= 0;
+			mid <= 0;
+			drop_ff <= 0;
+		end
+`ifdef DEBUG_RVC
+		if (out_if.done) begin
+			$display("RVC: pc %x iw=%x rvc=%d drop=%d",
+				out_if.pc, out_if.iw, out_if.rvc, drop);
+		end
+`endif
+	end
+endmodule
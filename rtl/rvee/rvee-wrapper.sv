@@ -5,6 +5,7 @@
 `include "rvee/rvee-exec.svh"
 `include "rvee/rvee-mem.svh"
 `include "rvee/rvee-rf.svh"
+`include "rvee/rvee-commit.svh"
 
 module rvee_wrapper #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	aclk,
@@ -12,6 +13,9 @@ module rvee_wrapper #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	[XLEN - 1:0] resetv,
 	input	meip, msip, mtip,
 	input	seip, ssip, stip,
+`ifdef RVEE_CONFIG_COMMIT_PORT
+	`RVEE_COMMIT_PORT(XLEN),
+`endif
 	`AXILITE_MASTER_PORT("FETCH", m00_, AWIDTH, DWIDTH),
 	`AXILITE_MASTER_PORT("MEM", m01_, AWIDTH, DWIDTH)
 	);
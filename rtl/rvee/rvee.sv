@@ -5,6 +5,7 @@
 `include "rvee/rvee-exec.svh"
 `include "rvee/rvee-mem.svh"
 `include "rvee/rvee-rf.svh"
+`include "rvee/rvee-commit.svh"
 
 module rvee_core #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	clk,
@@ -17,6 +18,9 @@ module rvee_core #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	seip,	// External interrupt pending
 	input	ssip,	// Software interrupt pending
 	input	stip,	// Timer interrupt pending
+`ifdef RVEE_CONFIG_COMMIT_PORT
+	`RVEE_COMMIT_PORT(XLEN),
+`endif
 	axi4lite_if.master_port axi_fetch_if,
 	axi4lite_if.master_port axi_mem_if);
 
@@ -32,9 +36,70 @@ module rvee_core #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	rvee_rf_ff rf(.*);
 	rvee_pcgen pcgen(.*);
 
+	// FENCE.I leaving decode, right before EX redirects fetch to the
+	// insn after it.
+	wire	fence_i_done = decode_if.done && decode_if.fence_i;
+	assign pcgen_if.bp_inval = fence_i_done;
+
+`ifdef RVEE_CONFIG_C
+	// Fetch returns words, rvee_rvc cuts them into insns and expands
+	// the compressed ones in front of decode.
+	rvee_fetch_if fetch_word_if(.*);
+	rvee_rvc rvc(.*, .in_if(fetch_word_if), .out_if(fetch_if));
+`endif
+
+`ifdef RVEE_CONFIG_ICACHE
+	// The I-cache sits between fetch and the fetch port. FENCE.I
+	// invalidates it once it leaves decode.
+	axi4lite_if axi_ic_if(.*);
+	wire	ic_hit;
+	wire	ic_miss;
+	rvee_icache icache(.*, .inval(fence_i_done), .ev_hit(ic_hit), .ev_miss(ic_miss),
+			   .s_if(axi_ic_if), .m_if(axi_fetch_if));
+	assign csr_if.ev_ic_hit = ic_hit;
+	assign csr_if.ev_ic_miss = ic_miss;
+`ifdef RVEE_CONFIG_C
+	rvee_fetch fetch(.*, .axi_fetch_if(axi_ic_if), .fetch_if(fetch_word_if));
+`else
+	rvee_fetch fetch(.*, .axi_fetch_if(axi_ic_if));
+`endif
+`else
+	assign csr_if.ev_ic_hit = 0;
+	assign csr_if.ev_ic_miss = 0;
+`ifdef RVEE_CONFIG_C
+	rvee_fetch fetch(.*, .fetch_if(fetch_word_if));
+`else
 	rvee_fetch fetch(.*);
+`endif
+`endif
 	rvee_decode decode(.*);
 	rvee_csr csr(.*);
 	rvee_exec exec(.*);
+`ifdef RVEE_CONFIG_DCACHE
+	// The D-cache sits between mem and the data port.
+	axi4lite_if axi_dc_if(.*);
+	wire	dc_hit;
+	wire	dc_miss;
+	wire	dc_evict;
+	rvee_dcache dcache(.*, .flush(mem_if.dc_flush), .clean(mem_if.dc_clean),
+			   .ev_hit(dc_hit), .ev_miss(dc_miss), .ev_evict(dc_evict),
+			   .s_if(axi_dc_if), .m_if(axi_mem_if));
+	assign csr_if.ev_dc_hit = dc_hit;
+	assign csr_if.ev_dc_miss = dc_miss;
+	assign csr_if.ev_dc_evict = dc_evict;
+	rvee_mem mem(.*, .axi_mem_if(axi_dc_if));
+`else
+	assign mem_if.dc_clean = 1;
+	assign csr_if.ev_dc_hit = 0;
+	assign csr_if.ev_dc_miss = 0;
+	assign csr_if.ev_dc_evict = 0;
 	rvee_mem mem(.*);
+`endif
+
+	// Performance counter events from the other stages.
+	assign csr_if.ev_retire = exec_if.done && !exec_if.trap && !mem_if.exception;
+	assign csr_if.ev_trap = exec_if.done && exec_if.trap;
+	assign csr_if.ev_mem_wait = exec_if.valid && !exec_if.ready;
+	assign csr_if.ev_redirect = (decode_if.done && pcgen_if.jmp) || pcgen_if.bcc ||
+				  pcgen_if.pjmp;
 endmodule
@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Report simulated cycles per second for the multi-threaded
+# Vrvee_tb_fast builds.
+#
+# Usage: bench-threads.sh objdir "1 2 4 8" image.bin...
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+objdir=$1
+threads=$2
+shift 2
+
+printf "%8s %12s %10s %12s\n" "threads" "cycles" "seconds" "cycles/s"
+for n in ${threads}; do
+	bin=${objdir}/mt${n}/Vrvee_tb_fast
+	total_cycles=0
+	total_us=0
+
+	for img in "$@"; do
+		# +stats reports "<cycles> cycles in <seconds> s (...)".
+		stats=$(${bin} ${img} +stats 2>&1 >/dev/null | grep " cycles in ")
+		cycles=$(echo "${stats}" | awk '{ print $1 }')
+		us=$(echo "${stats}" | awk '{ printf "%d", $4 * 1000000 }')
+		total_cycles=$((total_cycles + ${cycles:-0}))
+		total_us=$((total_us + ${us:-0}))
+	done
+
+	awk -v n=${n} -v c=${total_cycles} -v us=${total_us} 'BEGIN {
+		s = us / 1000000;
+		printf "%8d %12d %10.3f %12.0f\n", n, c, s, s > 0 ? c / s : 0;
+	}'
+done
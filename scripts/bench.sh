@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# Run the benchmark kernels (sw/bench) on Vrvee_tb_fast built with
+# different config options (obj_dir/cfg-<config>, see the Makefile)
+# and report cycles, retired insns and CPI per kernel. Kernels that
+# fail their self-check or run out of cycles are flagged and make
+# the script fail.
+#
+# Usage: bench.sh objdir "base LOAD_REGFW" kernel.elf...
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+objdir=$1
+configs=$2
+shift 2
+
+max_cycles=${BENCH_MAX_CYCLES:-10000000}
+ret=0
+
+printf "%-24s %-12s %12s %12s %8s\n" "config" "kernel" "cycles" "insns" "CPI"
+for c in ${configs}; do
+	bin=${objdir}/cfg-${c}/Vrvee_tb_fast
+
+	for img in "$@"; do
+		kernel=$(basename ${img} .elf)
+		# +perf prints one "<name> <value>" line per counter.
+		out=$(${bin} ${img} +perf +max-cycles=${max_cycles} 2>/dev/null)
+		status=$?
+		[ ${status} -eq 0 ] || ret=1
+
+		echo "${out}" | awk -v c=${c} -v k=${kernel} -v s=${status} '
+			/^cycles / { cycles = $2 }
+			/^insns / { insns = $2 }
+			END {
+				printf "%-24s %-12s %12d %12d %8.3f%s\n", c, k,
+					cycles, insns,
+					insns ? cycles / insns : 0,
+					s ? " FAIL" : "";
+			}'
+	done
+done
+exit ${ret}
@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# Report cycles, retired insns, decode hazard bubbles and CPI for
+# Vrvee_tb_fast built with different config options
+# (obj_dir/cfg-<config>, see the Makefile). Images that fail or run
+# out of cycles are left out of the totals, counted and make the
+# script fail.
+#
+# Usage: cpi.sh objdir "base LOAD_REGFW" image.bin...
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+objdir=$1
+configs=$2
+shift 2
+
+max_cycles=${CPI_MAX_CYCLES:-1000000}
+ret=0
+
+printf "%-24s %12s %12s %12s %8s\n" "config" "cycles" "insns" "hazards" "CPI"
+for c in ${configs}; do
+	bin=${objdir}/cfg-${c}/Vrvee_tb_fast
+
+	for img in "$@"; do
+		# +perf prints one "<name> <value>" line per counter.
+		if ! ${bin} ${img} +perf +max-cycles=${max_cycles} \
+			>${objdir}/cpi.out 2>/dev/null; then
+			echo "failed"
+			echo "${c}: ${img} failed" >&2
+			continue
+		fi
+		cat ${objdir}/cpi.out
+	done | awk -v c=${c} '
+		/^cycles / { cycles += $2 }
+		/^insns / { insns += $2 }
+		/^hazard bubbles / { hazards += $3 }
+		/^failed$/ { failed++ }
+		END {
+			printf "%-24s %12d %12d %12d %8.3f%s\n", c, cycles,
+				insns, hazards, insns ? cycles / insns : 0,
+				failed ? sprintf(" FAIL (%d skipped)", failed) : "";
+			exit failed != 0;
+		}' || ret=1
+done
+rm -f ${objdir}/cpi.out
+exit ${ret}
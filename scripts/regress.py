@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+#
+# Run test images on the RVee SoC testbench in parallel.
+#
+# A test passes when the firmware writes 0 to the EXIT register
+# (0xff000108) of the mock UART. Tests that write a non-zero code,
+# crash or run past their budget fail.
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+from xml.sax.saxutils import escape, quoteattr
+
+EXIT_RE = re.compile(rb"^EXIT (-?\d+)$", re.M)
+
+
+def run_test(args, image):
+    cmd = [args.sim, image] + args.plusargs
+    if args.max_cycles:
+        cmd.append("+max-cycles=%d" % args.max_cycles)
+
+    start = time.monotonic()
+    try:
+        p = subprocess.run(cmd, stdout=subprocess.PIPE,
+                           stderr=subprocess.STDOUT, timeout=args.timeout)
+        output = p.stdout
+        status = None
+    except subprocess.TimeoutExpired as e:
+        output = e.stdout or b""
+        status = "timeout"
+    elapsed = time.monotonic() - start
+
+    m = EXIT_RE.search(output)
+    code = int(m.group(1)) if m else None
+    if status is None:
+        if code is None:
+            status = "no-exit"
+        elif code != 0:
+            status = "exit %d" % code
+        elif p.returncode != 0:
+            status = "rc %d" % p.returncode
+        else:
+            status = "pass"
+
+    return {
+        "name": os.path.splitext(os.path.basename(image))[0],
+        "image": image,
+        "status": status,
+        "time": elapsed,
+        "output": output.decode("utf-8", "replace"),
+    }
+
+
+def write_junit(path, suite, results, elapsed):
+    failures = sum(r["status"] != "pass" for r in results)
+
+    with open(path, "w") as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        f.write('<testsuite name=%s tests="%d" failures="%d" time="%.3f">\n'
+                % (quoteattr(suite), len(results), failures, elapsed))
+        for r in results:
+            f.write('  <testcase classname=%s name=%s time="%.3f"'
+                    % (quoteattr(suite), quoteattr(r["name"]), r["time"]))
+            if r["status"] == "pass":
+                f.write('/>\n')
+                continue
+            f.write('>\n    <failure message=%s>%s</failure>\n  </testcase>\n'
+                    % (quoteattr(r["status"]), escape(r["output"])))
+        f.write('</testsuite>\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run test images on the RVee testbench in parallel.")
+    parser.add_argument("--sim", default="./obj_dir/Vrvee_tb",
+                        help="testbench binary")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="number of tests to run in parallel")
+    parser.add_argument("--timeout", type=float, default=60,
+                        help="wall-clock budget per test in seconds")
+    parser.add_argument("--max-cycles", type=int, default=0,
+                        help="cycle budget per test (needs +max-cycles support)")
+    parser.add_argument("--junit", help="write JUnit XML results to this file")
+    parser.add_argument("--suite", default="rvee", help="JUnit suite name")
+    parser.add_argument("--plusarg", dest="plusargs", action="append",
+                        default=[], help="extra testbench plusarg")
+    parser.add_argument("images", nargs="+")
+    args = parser.parse_args()
+
+    start = time.monotonic()
+    with ThreadPoolExecutor(max_workers=max(args.jobs, 1)) as ex:
+        results = list(ex.map(lambda i: run_test(args, i), args.images))
+    elapsed = time.monotonic() - start
+
+    failed = [r for r in results if r["status"] != "pass"]
+    width = max(len(r["name"]) for r in results)
+
+    for r in sorted(results, key=lambda r: r["time"], reverse=True):
+        print("%-*s %-10s %8.3f s" % (width, r["name"], r["status"], r["time"]))
+    print("%d tests, %d failed, %.3f s (%.3f s serial)"
+          % (len(results), len(failed), elapsed,
+             sum(r["time"] for r in results)))
+
+    if args.junit:
+        write_junit(args.junit, args.suite, results, elapsed)
+
+    for r in failed:
+        sys.stderr.write("--- %s (%s)\n%s\n" % (r["name"], r["status"],
+                                                r["output"]))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
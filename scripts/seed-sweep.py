@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# Run a unit testbench over many random seeds in parallel.
+#
+# Each run is bounded with +transactions=N. Failures are grouped by
+# assertion site (as reported by the FAIL: line from tb/sc_main.h) and
+# for every site we report the smallest failing seed and the seed that
+# failed after the fewest transactions, which is usually the easiest
+# one to debug.
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+FAIL_RE = re.compile(rb"^FAIL: seed=(\d+) transactions=(\d+) site=(\S+) ?(.*)$",
+                     re.M)
+PASS_RE = re.compile(rb"^PASS: ", re.M)
+
+
+def run_seed(args, seed):
+    cmd = [args.tb, str(seed), "+transactions=%d" % args.transactions]
+
+    try:
+        p = subprocess.run(cmd, stdout=subprocess.PIPE,
+                           stderr=subprocess.STDOUT, timeout=args.timeout)
+    except subprocess.TimeoutExpired:
+        return (seed, "timeout", None, "")
+
+    m = FAIL_RE.search(p.stdout)
+    if m:
+        site = m.group(3).decode()
+        # Strip the build directory, e.g ../tb/foo.cc.
+        site = os.path.basename(site)
+        return (seed, site, int(m.group(2)), m.group(4).decode("utf-8", "replace"))
+    if p.returncode != 0:
+        return (seed, "exit %d" % p.returncode, None, "")
+    if not PASS_RE.search(p.stdout):
+        return (seed, "no-pass", None, "")
+    return (seed, None, None, "")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run a unit testbench over many seeds in parallel.")
+    parser.add_argument("tb", help="testbench binary, e.g obj_dir/Vrvee_exec_tb")
+    parser.add_argument("-n", "--seeds", type=int, default=1000,
+                        help="number of seeds to run")
+    parser.add_argument("--start", type=int, default=1, help="first seed")
+    parser.add_argument("-t", "--transactions", type=int, default=1000,
+                        help="transactions per seed")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="number of seeds to run in parallel")
+    parser.add_argument("--timeout", type=float, default=120,
+                        help="wall-clock budget per seed in seconds")
+    args = parser.parse_args()
+
+    seeds = range(args.start, args.start + args.seeds)
+    sites = {}
+
+    with ThreadPoolExecutor(max_workers=max(args.jobs, 1)) as ex:
+        for seed, site, trans, msg in ex.map(lambda s: run_seed(args, s),
+                                             seeds):
+            if site is None:
+                continue
+            f = sites.setdefault(site, {
+                "count": 0, "min_seed": seed, "msg": msg,
+                "first_seed": seed, "first_trans": trans,
+            })
+            f["count"] += 1
+            f["min_seed"] = min(f["min_seed"], seed)
+            if trans is not None and (f["first_trans"] is None or
+                                      trans < f["first_trans"]):
+                f["first_seed"] = seed
+                f["first_trans"] = trans
+
+    failed = sum(f["count"] for f in sites.values())
+    print("%s: %d seeds, %d failed, %d unique failures"
+          % (args.tb, len(seeds), failed, len(sites)))
+    for site, f in sorted(sites.items(), key=lambda i: -i[1]["count"]):
+        print("  %s %s" % (site, f["msg"]))
+        print("    %d failures, min seed %d" % (f["count"], f["min_seed"]), end="")
+        if f["first_trans"] is not None:
+            print(", seed %d fails after %d transactions"
+                  % (f["first_seed"], f["first_trans"]), end="")
+        print()
+        print("    repro: %s %d +transactions=%d"
+              % (args.tb, f["first_seed"], args.transactions))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+#!/bin/sh
+#
+# Report the critical path of the core built with different config
+# options. yosys gives the logic depth in LUT levels after
+# synth_xilinx, vivado the post-route WNS and the resulting Fmax
+# against the clock in scripts/vivado/rvee-synth.xdc.
+#
+# A config is base or a +-separated list of options, as for make cpi.
+# Options with a value are written <option>-<value>, e.g BPRED-2.
+#
+# Usage: timing.sh yosys|vivado objdir "base BCC_DECODE"
+#
+# Copyright (C) 2022 Edgar E. Iglesias.
+# SPDX-License-Identifier: MIT
+
+tool=$1
+objdir=$2
+configs=$3
+YOSYS=${YOSYS:-yosys}
+VIVADO=${VIVADO:-vivado}
+
+period=$(sed -n 's/^create_clock -period \([0-9.]*\).*/\1/p' \
+	scripts/vivado/rvee-synth.xdc)
+
+mkdir -p ${objdir}
+case ${tool} in
+yosys)
+	printf "%-24s %12s\n" "config" "LUT levels";;
+vivado)
+	printf "%-24s %12s %12s\n" "config" "WNS (ns)" "Fmax (MHz)";;
+*)
+	echo "usage: $0 yosys|vivado objdir configs" >&2
+	exit 1;;
+esac
+
+for c in ${configs}; do
+	opts=""
+	for o in $(echo ${c} | tr + ' ' | tr - =); do
+		[ ${o} = base ] || opts="${opts} ${o}"
+	done
+	log=${objdir}/timing-${tool}-${c}.log
+
+	case ${tool} in
+	yosys)
+		defs=""
+		for o in ${opts}; do
+			defs="${defs} -DRVEE_CONFIG_${o}"
+		done
+		pre=""
+		if [ -n "${defs}" ]; then
+			pre="verilog_defaults -add ${defs}; "
+		fi
+		${YOSYS} -q -l ${log} \
+			-p "${pre}script scripts/rvee-synth.yosys; ltp -noff" \
+			>/dev/null || exit 1
+		# Longest topological path in rvee_tb (length=N):
+		levels=$(sed -n 's/^Longest topological path.*(length=\([0-9]*\)).*/\1/p' \
+			${log} | tail -n 1)
+		printf "%-24s %12s\n" ${c} ${levels}
+		;;
+	vivado)
+		rpt=${objdir}/timing-vivado-${c}.rpt
+		${VIVADO} -nojournal -nolog -mode batch \
+			-source scripts/vivado/rvee-synth.tcl \
+			-tclargs ${rpt} ${opts} >${log} || exit 1
+		# The first row after the WNS(ns) header and its underline.
+		awk -v c=${c} -v period=${period} '
+			/WNS\(ns\)/ && !wns_row { wns_row = NR + 2 }
+			NR == wns_row {
+				printf "%-24s %12.3f %12.1f\n", c, $1,
+					1000 / (period - $1);
+				exit;
+			}' ${rpt}
+		;;
+	esac
+done
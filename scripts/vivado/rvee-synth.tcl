@@ -1,12 +1,24 @@
 set_param general.maxThreads 16
 
+# Optional -tclargs <timing report> <option>..., each option defines
+# RVEE_CONFIG_<option> on top of rvee-config.svh (see scripts/timing.sh).
+set timing_rpt [lindex $argv 0]
+set defs {}
+foreach opt [lrange $argv 1 end] {
+	lappend defs -verilog_define RVEE_CONFIG_$opt
+}
+
 read_xdc scripts/vivado/rvee-synth.xdc
 
 read_verilog -sv rtl/rvee/rvee-pcgen.sv
 read_verilog -sv rtl/rvee/rvee-fetch.sv
+read_verilog -sv rtl/rvee/rvee-rvc.sv
+read_verilog -sv rtl/rvee/rvee-icache.sv
+read_verilog -sv rtl/rvee/rvee-dcache.sv
 read_verilog -sv rtl/rvee/rvee-decode.sv
 read_verilog -sv rtl/rvee/rvee-alu.sv
 read_verilog -sv rtl/rvee/rvee-exec.sv
+read_verilog -sv rtl/rvee/rvee-muldiv.sv
 read_verilog -sv rtl/rvee/rvee-csr.sv
 read_verilog -sv rtl/rvee/rvee-rf.sv
 read_verilog -sv rtl/rvee/rvee-mem.sv
@@ -15,7 +27,7 @@ read_verilog -sv rtl/plic/plic.sv
 #synth_design -part xczu9eg-ffvb1156-2-e -top rvee_core -include_dirs rtl/
 #synth_design -retiming -part xc7k70t-fbg676 -top rvee_core -include_dirs rtl/
 
-synth_design -directive PerformanceOptimized -retiming -part xczu9eg-ffvb1156-2-e -top rvee_core -include_dirs rtl/
+synth_design {*}$defs -directive PerformanceOptimized -retiming -part xczu9eg-ffvb1156-2-e -top rvee_core -include_dirs rtl/
 opt_design -aggressive_remap
 place_design
 phys_opt_design
@@ -26,4 +38,7 @@ route_design
 
 report_utilization
 report_timing
+if {$timing_rpt != ""} {
+	report_timing_summary -file $timing_rpt
+}
 write_verilog -force scripts/vivado/out.v
@@ -0,0 +1,53 @@
+/*
+ * RVee benchmark kernels, common helpers.
+ *
+ * The kernels run bare-metal on the testbench SoC (see tb/rvee_soc.h).
+ * Each one checks its own result, main() returns 0 on success and
+ * crt0.S hands that to the EXIT register. Cycles and insns come from
+ * the harness (+perf), not from the kernels.
+ *
+ * Stick to RV32I, no multiplies or divides, no libc.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+
+#define BENCH_UART_TX	((volatile uint32_t *) 0xff000030)
+#define BENCH_HEX	((volatile uint32_t *) 0xff000104)
+
+static inline void bench_puts(const char *s)
+{
+	while (*s) {
+		*BENCH_UART_TX = *s++;
+	}
+}
+
+// xorshift32, s must not be 0.
+static inline uint32_t bench_rand(uint32_t *s)
+{
+	uint32_t x = *s;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*s = x;
+	return x;
+}
+
+static inline int bench_check(const char *name, uint32_t got, uint32_t want)
+{
+	if (got != want) {
+		bench_puts(name);
+		bench_puts(": bad result\n");
+		*BENCH_HEX = got;
+		return 1;
+	}
+	return 0;
+}
+#endif
@@ -0,0 +1,128 @@
+/*
+ * RVee benchmark kernel: a branchy state machine.
+ *
+ * Splits a random stream of number-ish characters at commas and
+ * classifies each token as an integer, a float, a number with an
+ * exponent or invalid, in the spirit of CoreMark's state machine.
+ * Lots of poorly predictable branches.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include "bench.h"
+
+#define SIZE	2048
+#define ROUNDS	8
+#define WANT	0x51880755
+
+enum {
+	S_START,
+	S_SIGN,
+	S_INT,
+	S_FLOAT,
+	S_EXP,
+	S_EXP_SIGN,
+	S_SCI,
+	S_INVALID,
+	S_NUM,
+};
+
+static const char alphabet[16] = "0123456789+-.e, ";
+static char input[SIZE];
+static uint32_t count[S_NUM];
+
+static int is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static int next_state(int s, char c)
+{
+	switch (s) {
+	case S_START:
+		if (is_digit(c)) {
+			return S_INT;
+		}
+		if (c == '+' || c == '-') {
+			return S_SIGN;
+		}
+		if (c == '.') {
+			return S_FLOAT;
+		}
+		return S_INVALID;
+	case S_SIGN:
+		if (is_digit(c)) {
+			return S_INT;
+		}
+		if (c == '.') {
+			return S_FLOAT;
+		}
+		return S_INVALID;
+	case S_INT:
+		if (is_digit(c)) {
+			return S_INT;
+		}
+		if (c == '.') {
+			return S_FLOAT;
+		}
+		if (c == 'e') {
+			return S_EXP;
+		}
+		return S_INVALID;
+	case S_FLOAT:
+		if (is_digit(c)) {
+			return S_FLOAT;
+		}
+		if (c == 'e') {
+			return S_EXP;
+		}
+		return S_INVALID;
+	case S_EXP:
+		if (c == '+' || c == '-') {
+			return S_EXP_SIGN;
+		}
+		/* fall through */
+	case S_EXP_SIGN:
+	case S_SCI:
+		if (is_digit(c)) {
+			return S_SCI;
+		}
+		return S_INVALID;
+	default:
+		return S_INVALID;
+	}
+}
+
+int main(void)
+{
+	uint32_t seed = 1;
+	uint32_t sum = 0;
+	unsigned int i, r;
+	int s;
+
+	for (i = 0; i < SIZE; i++) {
+		input[i] = alphabet[bench_rand(&seed) & 15];
+	}
+
+	for (r = 0; r < ROUNDS; r++) {
+		s = S_START;
+		// Rotate the input a bit every round.
+		for (i = 0; i < SIZE; i++) {
+			char c = input[(i + r) & (SIZE - 1)];
+
+			if (c == ',') {
+				count[s]++;
+				s = S_START;
+			} else if (c != ' ') {
+				s = next_state(s, c);
+			}
+		}
+		count[s]++;
+	}
+	for (i = 0; i < S_NUM; i++) {
+		sum = (sum << 5) ^ (sum >> 27) ^ count[i];
+	}
+	return bench_check("fsm", sum, WANT);
+}
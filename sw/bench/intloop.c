@@ -0,0 +1,44 @@
+/*
+ * RVee benchmark kernel: integer loops.
+ *
+ * Adds, shifts, xors and a data dependent branch over a small table,
+ * i.e mostly the ALU, register forwarding and loop branches.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include "bench.h"
+
+#define N	256
+#define ROUNDS	64
+#define WANT	0x27920d81
+
+static uint32_t tab[N];
+
+int main(void)
+{
+	uint32_t seed = 1;
+	uint32_t sum = 0;
+	uint32_t i, r;
+
+	for (i = 0; i < N; i++) {
+		tab[i] = bench_rand(&seed);
+	}
+
+	for (r = 0; r < ROUNDS; r++) {
+		for (i = 0; i < N; i++) {
+			uint32_t x = tab[i] ^ r;
+
+			sum += (x >> 3) + (x << 1);
+			sum ^= sum >> 7;
+			if ((int32_t) x < 0) {
+				sum += i;
+			} else {
+				sum -= r;
+			}
+		}
+	}
+	return bench_check("intloop", sum, WANT);
+}
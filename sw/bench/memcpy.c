@@ -0,0 +1,63 @@
+/*
+ * RVee benchmark kernel: memcpy.
+ *
+ * Aligned word copies and misaligned byte copies of an 8K buffer,
+ * i.e back-to-back loads and stores.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include "bench.h"
+
+#define SIZE	8192
+#define ROUNDS	8
+#define WANT	0xf13173be
+
+static uint32_t src[SIZE / 4];
+static uint32_t dst[SIZE / 4];
+
+static void __attribute__((noinline))
+copy_words(uint32_t *d, const uint32_t *s, unsigned int n)
+{
+	for (; n >= 4; n -= 4, d += 4, s += 4) {
+		d[0] = s[0];
+		d[1] = s[1];
+		d[2] = s[2];
+		d[3] = s[3];
+	}
+	for (; n; n--) {
+		*d++ = *s++;
+	}
+}
+
+static void __attribute__((noinline))
+copy_bytes(uint8_t *d, const uint8_t *s, unsigned int n)
+{
+	for (; n; n--) {
+		*d++ = *s++;
+	}
+}
+
+int main(void)
+{
+	uint32_t seed = 1;
+	uint32_t sum = 0;
+	unsigned int i, r;
+
+	for (i = 0; i < SIZE / 4; i++) {
+		src[i] = bench_rand(&seed);
+	}
+
+	for (r = 0; r < ROUNDS; r++) {
+		copy_words(dst, src, SIZE / 4);
+		copy_bytes((uint8_t *) dst + 1, (const uint8_t *) src + r,
+			   SIZE - ROUNDS);
+		sum += dst[r] ^ dst[SIZE / 4 - 1 - r];
+	}
+	for (i = 0; i < SIZE / 4; i++) {
+		sum = (sum << 1 | sum >> 31) ^ dst[i];
+	}
+	return bench_check("memcpy", sum, WANT);
+}
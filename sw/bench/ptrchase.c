@@ -0,0 +1,62 @@
+/*
+ * RVee benchmark kernel: pointer chasing.
+ *
+ * Walks a linked list laid out as a single random cycle over 32K of
+ * nodes, larger than the default D-cache. Every load depends on the
+ * previous one, so this is all load latency.
+ *
+ * Copyright (C) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+#include "bench.h"
+
+#define N	4096
+#define STEPS	32768
+#define WANT	0x1e7c0000
+
+struct node {
+	struct node *next;
+	uint32_t val;
+};
+
+static struct node nodes[N];
+static uint16_t perm[N];
+
+int main(void)
+{
+	uint32_t seed = 1;
+	uint32_t sum = 0;
+	struct node *p;
+	unsigned int i, j, mask;
+	uint16_t t;
+
+	// Sattolo's shuffle, one cycle through all nodes.
+	for (i = 0; i < N; i++) {
+		perm[i] = i;
+	}
+	mask = N - 1;
+	for (i = N - 1; i > 0; i--) {
+		while (mask >> 1 >= i) {
+			mask >>= 1;
+		}
+		do {
+			j = bench_rand(&seed) & mask;
+		} while (j >= i);
+		t = perm[i];
+		perm[i] = perm[j];
+		perm[j] = t;
+	}
+	for (i = 0; i < N; i++) {
+		nodes[perm[i]].next = &nodes[perm[(i + 1) & (N - 1)]];
+		nodes[perm[i]].val = i;
+	}
+
+	p = &nodes[0];
+	for (i = 0; i < STEPS; i++) {
+		sum += p->val ^ i;
+		p = p->next;
+	}
+	return bench_check("ptrchase", sum, WANT);
+}
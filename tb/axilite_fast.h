@@ -0,0 +1,469 @@
+/*
+ * Cycle-driven AXI-Lite models.
+ *
+ * These are plain C++ models that are clocked once per rising edge
+ * with a snapshot of the AXI-Lite pins. They don't use TLM nor
+ * SystemC processes, the caller is responsible for moving pin values
+ * in and out of the simulator (see the axilite_pins_* helpers for
+ * SystemC signals).
+ *
+ * axilite_target serves a master port (e.g the RVee fetch or mem ports)
+ * from an axilite_dev, typically an axilite_bus with RAM and devices
+ * mapped into it.
+ *
+ * axilite_initiator is an axilite_dev that proxies accesses out onto
+ * an AXI-Lite target port (e.g the CLINT).
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_AXILITE_FAST_H__
+#define __TB_AXILITE_FAST_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define AXILITE_RESP_OKAY   0
+#define AXILITE_RESP_EXOKAY 1
+#define AXILITE_RESP_SLVERR 2
+#define AXILITE_RESP_DECERR 3
+
+struct axilite_pins {
+	// Driven by the master.
+	bool arvalid;
+	uint32_t araddr;
+	bool awvalid;
+	uint32_t awaddr;
+	bool wvalid;
+	uint32_t wdata;
+	uint8_t wstrb;
+	bool rready;
+	bool bready;
+
+	// Driven by the target.
+	bool arready;
+	bool rvalid;
+	uint32_t rdata;
+	uint8_t rresp;
+	bool awready;
+	bool wready;
+	bool bvalid;
+	uint8_t bresp;
+};
+
+class axilite_dev {
+public:
+	virtual ~axilite_dev() {}
+
+	// Accesses are 32-bit aligned. Return false if the access needs
+	// more time, it will be retried with the same arguments on the
+	// next clock edge.
+	virtual bool read(uint64_t addr, uint32_t *data, uint8_t *resp) = 0;
+	virtual bool write(uint64_t addr, uint32_t data, uint8_t strb,
+			   uint8_t *resp) = 0;
+};
+
+class axilite_ram : public axilite_dev {
+public:
+	uint8_t *buf;
+	uint64_t size;
+	bool readonly;
+
+	axilite_ram(uint8_t *buf, uint64_t size, bool readonly = false) :
+		buf(buf), size(size), readonly(readonly) {}
+
+	bool read(uint64_t addr, uint32_t *data, uint8_t *resp) {
+		if (addr + 4 > size) {
+			*resp = AXILITE_RESP_SLVERR;
+			return true;
+		}
+		memcpy(data, buf + addr, 4);
+		*resp = AXILITE_RESP_OKAY;
+		return true;
+	}
+
+	bool write(uint64_t addr, uint32_t data, uint8_t strb, uint8_t *resp) {
+		unsigned int i;
+
+		if (addr + 4 > size || readonly) {
+			*resp = AXILITE_RESP_SLVERR;
+			return true;
+		}
+		if (strb == 0xf) {
+			memcpy(buf + addr, &data, 4);
+		} else {
+			for (i = 0; i < 4; i++) {
+				if (strb & (1 << i))
+					buf[addr + i] = data >> (i * 8);
+			}
+		}
+		*resp = AXILITE_RESP_OKAY;
+		return true;
+	}
+};
+
+// Address decoder. Devices see addresses relative to their base.
+class axilite_bus : public axilite_dev {
+public:
+	struct mapping {
+		uint64_t base;
+		uint64_t size;
+		axilite_dev *dev;
+	};
+	std::vector<mapping> map;
+
+	void memmap(uint64_t base, uint64_t size, axilite_dev *dev) {
+		mapping m = { base, size, dev };
+
+		map.push_back(m);
+	}
+
+	mapping *decode(uint64_t addr) {
+		unsigned int i;
+
+		for (i = 0; i < map.size(); i++) {
+			if (addr >= map[i].base && addr - map[i].base < map[i].size) {
+				return &map[i];
+			}
+		}
+		return NULL;
+	}
+
+	bool read(uint64_t addr, uint32_t *data, uint8_t *resp) {
+		mapping *m = decode(addr);
+
+		if (!m) {
+			*data = 0;
+			*resp = AXILITE_RESP_DECERR;
+			return true;
+		}
+		return m->dev->read(addr - m->base, data, resp);
+	}
+
+	bool write(uint64_t addr, uint32_t data, uint8_t strb, uint8_t *resp) {
+		mapping *m = decode(addr);
+
+		if (!m) {
+			*resp = AXILITE_RESP_DECERR;
+			return true;
+		}
+		return m->dev->write(addr - m->base, data, strb, resp);
+	}
+};
+
+// Serves an AXI-Lite master port.
+//
+// Reads are pipelined, we accept a new AR every cycle as long as there's
+// room for the response. Responses come out the cycle after the AR
+// handshake unless the device stalls.
+class axilite_target {
+public:
+	axilite_dev *dev;
+
+	axilite_target(axilite_dev *dev) : dev(dev) {
+		reset(NULL);
+	}
+
+	void reset(axilite_pins *p) {
+		ar_pending = false;
+		aw_valid = false;
+		w_valid = false;
+		b_valid = false;
+		b_resp = 0;
+		rq_head = 0;
+		rq_count = 0;
+		memset(rq, 0, sizeof rq);
+
+		if (p) {
+			p->arready = false;
+			p->rvalid = false;
+			p->awready = false;
+			p->wready = false;
+			p->bvalid = false;
+		}
+	}
+
+	// Call on every rising edge with the pin values sampled prior to
+	// the edge. Updates the target driven pins.
+	void clock(axilite_pins *p) {
+		if (p->rvalid && p->rready) {
+			rq_head = (rq_head + 1) % RQ_SIZE;
+			rq_count--;
+		}
+		if (p->bvalid && p->bready) {
+			b_valid = false;
+		}
+		if (p->arvalid && p->arready) {
+			ar_pending = true;
+			ar_addr = p->araddr & ~3;
+		}
+		if (p->awvalid && p->awready) {
+			aw_valid = true;
+			aw_addr = p->awaddr & ~3;
+		}
+		if (p->wvalid && p->wready) {
+			w_valid = true;
+			w_data = p->wdata;
+			w_strb = p->wstrb;
+		}
+
+		if (ar_pending && rq_count < RQ_SIZE) {
+			unsigned int i = (rq_head + rq_count) % RQ_SIZE;
+
+			if (dev->read(ar_addr, &rq[i].data, &rq[i].resp)) {
+				rq_count++;
+				ar_pending = false;
+			}
+		}
+		if (aw_valid && w_valid && !b_valid) {
+			if (dev->write(aw_addr, w_data, w_strb, &b_resp)) {
+				b_valid = true;
+				aw_valid = false;
+				w_valid = false;
+			}
+		}
+
+		p->arready = !ar_pending;
+		p->rvalid = rq_count > 0;
+		p->rdata = rq[rq_head].data;
+		p->rresp = rq[rq_head].resp;
+		p->awready = !aw_valid;
+		p->wready = !w_valid;
+		p->bvalid = b_valid;
+		p->bresp = b_resp;
+	}
+
+	// Checkpointing (see rvee_ckpt.h), a.io() moves each piece of
+	// state in or out.
+	template<typename A>
+	void ckpt(A &a) {
+		a.io(rq, sizeof rq);
+		a.io(&rq_head, sizeof rq_head);
+		a.io(&rq_count, sizeof rq_count);
+		a.io(&ar_pending, sizeof ar_pending);
+		a.io(&ar_addr, sizeof ar_addr);
+		a.io(&aw_valid, sizeof aw_valid);
+		a.io(&aw_addr, sizeof aw_addr);
+		a.io(&w_valid, sizeof w_valid);
+		a.io(&w_data, sizeof w_data);
+		a.io(&w_strb, sizeof w_strb);
+		a.io(&b_valid, sizeof b_valid);
+		a.io(&b_resp, sizeof b_resp);
+	}
+
+private:
+	enum { RQ_SIZE = 2 };
+	struct {
+		uint32_t data;
+		uint8_t resp;
+	} rq[RQ_SIZE];
+	unsigned int rq_head;
+	unsigned int rq_count;
+
+	bool ar_pending;
+	uint64_t ar_addr;
+
+	bool aw_valid;
+	uint64_t aw_addr;
+	bool w_valid;
+	uint32_t w_data;
+	uint8_t w_strb;
+
+	bool b_valid;
+	uint8_t b_resp;
+};
+
+// Proxies device accesses onto an AXI-Lite target port.
+// One access at a time.
+class axilite_initiator : public axilite_dev {
+public:
+	axilite_initiator() {
+		reset(NULL);
+	}
+
+	void reset(axilite_pins *p) {
+		state = IDLE;
+
+		if (p) {
+			p->arvalid = false;
+			p->awvalid = false;
+			p->wvalid = false;
+			p->rready = false;
+			p->bready = false;
+		}
+	}
+
+	bool read(uint64_t addr, uint32_t *data, uint8_t *resp) {
+		return access(false, addr, data, 0, resp);
+	}
+
+	bool write(uint64_t addr, uint32_t data, uint8_t strb, uint8_t *resp) {
+		return access(true, addr, &data, strb, resp);
+	}
+
+	// Call on every rising edge with the pin values sampled prior to
+	// the edge. Updates the master driven pins.
+	void clock(axilite_pins *p) {
+		bool ardone = p->arvalid && p->arready;
+		bool awdone = p->awvalid && p->awready;
+		bool wdone = p->wvalid && p->wready;
+		bool rdone = p->rvalid && p->rready;
+		bool bdone = p->bvalid && p->bready;
+
+		switch (state) {
+		case REQ:
+			p->araddr = addr;
+			p->awaddr = addr;
+			p->wdata = data;
+			p->wstrb = strb;
+			p->arvalid = !is_write;
+			p->awvalid = is_write;
+			p->wvalid = is_write;
+			p->rready = true;
+			p->bready = true;
+			state = BUSY;
+			break;
+		case BUSY:
+			if (ardone) {
+				p->arvalid = false;
+			}
+			if (awdone) {
+				p->awvalid = false;
+			}
+			if (wdone) {
+				p->wvalid = false;
+			}
+			if (rdone) {
+				data = p->rdata;
+				resp = p->rresp;
+				state = DONE;
+			}
+			if (bdone) {
+				resp = p->bresp;
+				state = DONE;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	template<typename A>
+	void ckpt(A &a) {
+		a.io(&state, sizeof state);
+		a.io(&is_write, sizeof is_write);
+		a.io(&addr, sizeof addr);
+		a.io(&data, sizeof data);
+		a.io(&strb, sizeof strb);
+		a.io(&resp, sizeof resp);
+	}
+
+private:
+	enum { IDLE, REQ, BUSY, DONE } state;
+	bool is_write;
+	uint64_t addr;
+	uint32_t data;
+	uint8_t strb;
+	uint8_t resp;
+
+	bool access(bool wr, uint64_t a, uint32_t *d, uint8_t s, uint8_t *r) {
+		if (state == IDLE) {
+			state = REQ;
+			is_write = wr;
+			addr = a;
+			data = *d;
+			strb = s;
+			return false;
+		}
+		// Another access is in flight, it completes first.
+		if (wr != is_write || a != addr) {
+			return false;
+		}
+		if (state == DONE) {
+			if (!wr) {
+				*d = data;
+			}
+			*r = resp;
+			state = IDLE;
+			return true;
+		}
+		return false;
+	}
+};
+
+// Helpers to move pins in and out of AXILiteSignals style sc_signals.
+template<typename S>
+static inline void axilite_pins_get_master(axilite_pins *p, S &s)
+{
+	p->arvalid = s.arvalid.read();
+	p->araddr = s.araddr.read().to_uint();
+	p->awvalid = s.awvalid.read();
+	p->awaddr = s.awaddr.read().to_uint();
+	p->wvalid = s.wvalid.read();
+	p->wdata = s.wdata.read().to_uint();
+	p->wstrb = s.wstrb.read().to_uint();
+	p->rready = s.rready.read();
+	p->bready = s.bready.read();
+}
+
+template<typename S>
+static inline void axilite_pins_put_target(S &s, const axilite_pins *p)
+{
+	s.arready.write(p->arready);
+	s.rvalid.write(p->rvalid);
+	s.rdata.write(p->rdata);
+	s.rresp.write(p->rresp);
+	s.awready.write(p->awready);
+	s.wready.write(p->wready);
+	s.bvalid.write(p->bvalid);
+	s.bresp.write(p->bresp);
+}
+
+template<typename S>
+static inline void axilite_pins_get_target(axilite_pins *p, S &s)
+{
+	p->arready = s.arready.read();
+	p->rvalid = s.rvalid.read();
+	p->rdata = s.rdata.read().to_uint();
+	p->rresp = s.rresp.read().to_uint();
+	p->awready = s.awready.read();
+	p->wready = s.wready.read();
+	p->bvalid = s.bvalid.read();
+	p->bresp = s.bresp.read().to_uint();
+}
+
+template<typename S>
+static inline void axilite_pins_put_master(S &s, const axilite_pins *p)
+{
+	s.arvalid.write(p->arvalid);
+	s.araddr.write(p->araddr);
+	s.arprot.write(0);
+	s.awvalid.write(p->awvalid);
+	s.awaddr.write(p->awaddr);
+	s.awprot.write(0);
+	s.wvalid.write(p->wvalid);
+	s.wdata.write(p->wdata);
+	s.wstrb.write(p->wstrb);
+	s.rready.write(p->rready);
+	s.bready.write(p->bready);
+}
+#endif
@@ -39,6 +39,7 @@ using namespace sc_core;
 using namespace sc_dt;
 using namespace std;
 
+#include "utils.h"
 #include "trace/trace.h"
 #include "Vclint_tb.h"
 #include "verilated_vcd_sc.h"
@@ -185,7 +186,7 @@ SC_MODULE(Top)
 				ipi[target_ipi] |= wdata_ipi & 1;
 
 				dev_write32(addr_ipi, wdata_ipi);
-				printf("do ipi[%d]=%d\n", target_ipi, ipi[target_ipi]);
+				TB_LOG(TB_LOG_DEBUG, "do ipi[%d]=%d\n", target_ipi, ipi[target_ipi]);
 			}
 			if (setup.do_timecmp) {
 				target_tc = rand_r(&rand_seed) % NUM_TARGETS;
@@ -198,7 +199,7 @@ SC_MODULE(Top)
 
 				dev_write32(addr_tc, wdata_tc);
 				dev_write32(addr_tc + 4, wdata_tc >> 32);
-				printf("do timecmp[%d]=%lx\n", target_tc, timecmp[target_tc]);
+				TB_LOG(TB_LOG_DEBUG, "do timecmp[%d]=%lx\n", target_tc, timecmp[target_tc]);
 			}
 
 			if (setup.do_mtime) {
@@ -220,7 +221,7 @@ SC_MODULE(Top)
 				dev_write32(CLINT_MTIME + 4, wdata >> 32);
 				dev_write32(CLINT_MTIME, wdata);
 
-				printf("do-mtime = %lx rdata=%lx\n", wdata, rdata);
+				TB_LOG(TB_LOG_DEBUG, "do-mtime = %lx rdata=%lx\n", wdata, rdata);
 			}
 
 			wait(clk.posedge_event());
@@ -252,6 +253,7 @@ SC_MODULE(Top)
 					mtime, t, timecmp[t], tip));
 				sc_assert((mtime >= timecmp[t]) == tip);
 			}
+			tb_transaction_done();
 		}
 	}
 
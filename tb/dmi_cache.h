@@ -0,0 +1,195 @@
+/*
+ * TLM DMI cache.
+ *
+ * Sits between a TLM initiator (e.g an AXI-Lite to TLM bridge) and the
+ * interconnect. Once a target grants DMI, accesses that hit the granted
+ * range are served straight from host memory without walking the
+ * interconnect and the target's b_transport.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_DMI_CACHE_H__
+#define __TB_DMI_CACHE_H__
+
+#include <vector>
+
+#include "systemc.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+
+class dmi_cache : public sc_core::sc_module
+{
+public:
+	tlm_utils::simple_target_socket<dmi_cache> target_socket;
+	tlm_utils::simple_initiator_socket<dmi_cache> init_socket;
+
+	// When disabled, we're a plain pass-through.
+	bool enabled;
+
+	uint64_t hits;
+	uint64_t misses;
+
+	SC_HAS_PROCESS(dmi_cache);
+
+	dmi_cache(sc_core::sc_module_name name, bool enabled = false) :
+		sc_module(name),
+		target_socket("target-socket"),
+		init_socket("init-socket"),
+		enabled(enabled),
+		hits(0),
+		misses(0)
+	{
+		target_socket.register_b_transport(this, &dmi_cache::b_transport);
+		target_socket.register_transport_dbg(this, &dmi_cache::transport_dbg);
+		target_socket.register_get_direct_mem_ptr(this,
+				&dmi_cache::get_direct_mem_ptr);
+		init_socket.register_invalidate_direct_mem_ptr(this,
+				&dmi_cache::invalidate_direct_mem_ptr);
+	}
+
+private:
+	std::vector<tlm::tlm_dmi> regions;
+
+	tlm::tlm_dmi *lookup(uint64_t addr, unsigned int len) {
+		unsigned int i;
+
+		for (i = 0; i < regions.size(); i++) {
+			tlm::tlm_dmi *d = &regions[i];
+
+			if (addr >= d->get_start_address() &&
+			    addr + len - 1 <= d->get_end_address()) {
+				return d;
+			}
+		}
+		return NULL;
+	}
+
+	// Returns true if the access was served from a DMI region.
+	bool dmi_access(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		uint64_t addr = trans.get_address();
+		unsigned int len = trans.get_data_length();
+		unsigned char *data = trans.get_data_ptr();
+		unsigned char *be = trans.get_byte_enable_ptr();
+		unsigned int be_len = trans.get_byte_enable_length();
+		unsigned char *host;
+		tlm::tlm_dmi *d;
+		unsigned int i;
+
+		if (trans.get_streaming_width() < len) {
+			return false;
+		}
+
+		d = lookup(addr, len);
+		if (!d) {
+			return false;
+		}
+
+		host = d->get_dmi_ptr() + (addr - d->get_start_address());
+		if (trans.is_read()) {
+			if (!d->is_read_allowed()) {
+				return false;
+			}
+			if (be_len) {
+				for (i = 0; i < len; i++) {
+					if (be[i % be_len] == TLM_BYTE_ENABLED)
+						data[i] = host[i];
+				}
+			} else {
+				memcpy(data, host, len);
+			}
+			delay += d->get_read_latency();
+		} else if (trans.is_write()) {
+			if (!d->is_write_allowed()) {
+				return false;
+			}
+			if (be_len) {
+				for (i = 0; i < len; i++) {
+					if (be[i % be_len] == TLM_BYTE_ENABLED)
+						host[i] = data[i];
+				}
+			} else {
+				memcpy(host, data, len);
+			}
+			delay += d->get_write_latency();
+		} else {
+			return false;
+		}
+
+		trans.set_dmi_allowed(true);
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+		return true;
+	}
+
+	void acquire(tlm::tlm_generic_payload& trans) {
+		tlm::tlm_generic_payload t;
+		tlm::tlm_dmi d;
+
+		t.set_command(tlm::TLM_READ_COMMAND);
+		t.set_address(trans.get_address());
+		t.set_data_length(0);
+		if (init_socket->get_direct_mem_ptr(t, d)) {
+			regions.push_back(d);
+		}
+	}
+
+	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		if (enabled && dmi_access(trans, delay)) {
+			hits++;
+			return;
+		}
+
+		misses++;
+		init_socket->b_transport(trans, delay);
+		if (enabled && trans.is_dmi_allowed() &&
+		    !lookup(trans.get_address(), 1)) {
+			acquire(trans);
+		}
+	}
+
+	unsigned int transport_dbg(tlm::tlm_generic_payload& trans) {
+		return init_socket->transport_dbg(trans);
+	}
+
+	bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans,
+				tlm::tlm_dmi& dmi_data) {
+		return init_socket->get_direct_mem_ptr(trans, dmi_data);
+	}
+
+	// Called by targets when a mapping changes (remap, unmap etc).
+	void invalidate_direct_mem_ptr(sc_dt::uint64 start,
+				       sc_dt::uint64 end) {
+		unsigned int i = 0;
+
+		while (i < regions.size()) {
+			tlm::tlm_dmi *d = &regions[i];
+
+			if (start <= d->get_end_address() &&
+			    end >= d->get_start_address()) {
+				regions.erase(regions.begin() + i);
+			} else {
+				i++;
+			}
+		}
+		target_socket->invalidate_direct_mem_ptr(start, end);
+	}
+};
+#endif
@@ -39,6 +39,7 @@ using namespace sc_core;
 using namespace sc_dt;
 using namespace std;
 
+#include "utils.h"
 #include "trace/trace.h"
 #include "Vplic_tb.h"
 #include "verilated_vcd_sc.h"
@@ -217,7 +218,7 @@ SC_MODULE(Top)
 				dev_write32(addr, wdata);
 				prio[src] = wdata & MAX_PRIO;
 
-				printf("do_prio: prio[%d]=%x addr=%lx wdata=%x\n",
+				TB_LOG(TB_LOG_DEBUG, "do_prio: prio[%d]=%x addr=%lx wdata=%x\n",
 					src, prio[src], addr, wdata);
 			} else if (setup.do_enable) {
 				target_en = rand_r(&rand_seed) % NUM_TARGETS;
@@ -236,11 +237,11 @@ SC_MODULE(Top)
 						break;
 
 					enable[target_en][src + i] = !!(wdata & (1ULL << i));
-					printf("enable[%d] = %d\n",
+					TB_LOG(TB_LOG_DEBUG, "enable[%d] = %d\n",
 						src + i, enable[target_en][src + i]);
 				}
 
-				printf("do_enable: src=%d target=%x addr=%lx wdata=%x\n",
+				TB_LOG(TB_LOG_DEBUG, "do_enable: src=%d target=%x addr=%lx wdata=%x\n",
 					src, target_en, addr, wdata);
 			}
 
@@ -255,7 +256,7 @@ SC_MODULE(Top)
 				bv = source.read();
 				bv[src_flip] ^= '1';
 
-				printf("SRC: %d\n", src_flip);
+				TB_LOG(TB_LOG_DEBUG, "SRC: %d\n", src_flip);
 				source.write(bv);
 				wait(clk.posedge_event());
 			}
@@ -268,7 +269,7 @@ SC_MODULE(Top)
 				wdata_tp = rand_r(&rand_seed);
 				dev_write32(addr_tp, wdata_tp);
 
-				printf("target-prio[%d] = %x\n", target_tp, wdata_tp);
+				TB_LOG(TB_LOG_DEBUG, "target-prio[%d] = %x\n", target_tp, wdata_tp);
 				target_prio[target_tp] = wdata_tp & MAX_PRIO;
 			}
 
@@ -279,7 +280,7 @@ SC_MODULE(Top)
 				update_targets();
 				rdata = dev_read32(addr_claim);
 
-				printf("claimed target[%d]=%d %d\n",
+				TB_LOG(TB_LOG_DEBUG, "claimed target[%d]=%d %d\n",
 					target_claim, rdata, irq_id[target_claim]);
 				sc_assert(irq_id[target_claim] == rdata);
 
@@ -293,17 +294,17 @@ SC_MODULE(Top)
 				addr_complete = PLIC_BASE_CONTEXT + target_complete * 0x1000 + 4;
 				dev_write32(addr_complete, src_complete);
 
-				printf("completed %d\n", src_complete);
+				TB_LOG(TB_LOG_DEBUG, "completed %d\n", src_complete);
 				if (claim_target[src_complete] == target_complete) {
 					claim[src_complete] = 0;
 				} else {
-					printf("COMPLETE for non claimed source\n");
+					TB_LOG(TB_LOG_DEBUG, "COMPLETE for non claimed source\n");
 				}
 			}
 
 			if (setup.do_prio || setup.do_enable) {
 				rdata = dev_read32(addr);
-				printf("rdata=%x\n", rdata);
+				TB_LOG(TB_LOG_DEBUG, "rdata=%x\n", rdata);
 
 				if (setup.do_prio) {
 					sc_assert(rdata == prio[src]);
@@ -311,7 +312,7 @@ SC_MODULE(Top)
 					for (i = 0; i < 32; i++) {
 						if (src + i >= NUM_SOURCES)
 							break;
-						printf("enable[%d]=%d %d\n", src + i,
+						TB_LOG(TB_LOG_DEBUG, "enable[%d]=%d %d\n", src + i,
 							enable[target_en][src + i], !!(rdata & (1ULL << i)));
 						sc_assert(enable[target_en][src + i] == !!(rdata & (1ULL << i)));
 					}
@@ -326,7 +327,7 @@ SC_MODULE(Top)
 				v &= !claim[src_flip];
 				i = src_flip % 32;
 
-				printf("pending[%d]= %d src=%d claim=%d %d\n", src_flip,
+				TB_LOG(TB_LOG_DEBUG, "pending[%d]= %d src=%d claim=%d %d\n", src_flip,
 					v, (bv[src_flip] == '1'), claim[src_flip],
 					!!(rdata & (1ULL << i)));
 				sc_assert(v == !!(rdata & (1ULL << i)));
@@ -341,7 +342,7 @@ SC_MODULE(Top)
 					t, irq_id[t], target.read()[t] == '1'));
 				sc_assert(!!irq_id[t] == (target.read()[t] == '1'));
 			}
-
+			tb_transaction_done();
 		}
 	}
 
@@ -0,0 +1,64 @@
+/*
+ * Helpers to parse Verilator plusargs.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_PLUSARGS_H__
+#define __TB_PLUSARGS_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "verilated.h"
+
+// True if +<name> was given. Unlike a plain commandArgsPlusMatch(),
+// +<name> does not match +<name>-foo or +<name>=x.
+static inline bool plusarg_flag(const char *name)
+{
+	const char *flag = Verilated::commandArgsPlusMatch(name);
+
+	return flag && flag[0] == '+' && !strcmp(flag + 1, name);
+}
+
+// Value of +<name>=<val>, or def if not given.
+// commandArgsPlusMatch() reuses its buffer so we return a copy that
+// lives until exit.
+static inline const char *plusarg_str(const char *name, const char *def)
+{
+	const char *flag = Verilated::commandArgsPlusMatch(name);
+	size_t len = strlen(name);
+
+	if (!flag || flag[0] != '+' || strncmp(flag + 1, name, len) ||
+	    flag[len + 1] != '=') {
+		return def;
+	}
+	return strdup(flag + len + 2);
+}
+
+static inline uint64_t plusarg_u64(const char *name, uint64_t def)
+{
+	const char *val = plusarg_str(name, NULL);
+
+	return val ? strtoull(val, NULL, 0) : def;
+}
+#endif
@@ -1,3 +1,6 @@
+#ifndef __TB_RVEE_H__
+#define __TB_RVEE_H__
+
 #define AWIDTH 32
 #define DWIDTH 32
 
@@ -29,6 +32,8 @@ typedef enum {
 	I_LD_TYPE = 0x3,
 	I_ALU_TYPE = 0x13,
 	R_ALU_TYPE = 0x33,
+	FENCE_TYPE = 0xf,
+	SYSTEM_TYPE = 0x73,
 } rv_opcode_t;
 
 typedef enum {
@@ -51,7 +56,7 @@ typedef enum {
 	CC_GEU = 7,
 } rv_cc_t;
 
-xlen_t rv_sext(unsigned int w, uint32_t v)
+static inline xlen_t rv_sext(unsigned int w, uint32_t v)
 {
 	xlen_t r = v;
 
@@ -61,6 +66,26 @@ xlen_t rv_sext(unsigned int w, uint32_t v)
 	return r;
 }
 
+// RV32M reference, op is funct3. Division by zero and overflow
+// don't trap, they return what the spec mandates.
+static inline xlen_t rv_muldiv(unsigned int op, xlen_t a, xlen_t b)
+{
+	sxlen_t sa = a;
+	sxlen_t sb = b;
+	bool ovf = sa == (sxlen_t) (1ULL << (XLEN - 1)) && sb == -1;
+
+	switch (op) {
+	case 0: return (int64_t) sa * sb;
+	case 1: return ((int64_t) sa * sb) >> XLEN;
+	case 2: return ((int64_t) sa * (int64_t) (uint64_t) b) >> XLEN;
+	case 3: return ((uint64_t) a * b) >> XLEN;
+	case 4: return b == 0 ? XLEN_MAX : ovf ? a : sa / sb;
+	case 5: return b == 0 ? XLEN_MAX : a / b;
+	case 6: return b == 0 ? a : ovf ? 0 : sa % sb;
+	default: return b == 0 ? a : a % b;
+	}
+}
+
 static inline uint32_t gen_jal_imm(uint32_t v) {
 	uint32_t imm;
 
@@ -172,3 +197,120 @@ static inline uint32_t rvee_encode_i(rv_opcode_t opcode,
 		imm << 20;
 	return iw;
 }
+
+// RV32C. Expands a 16-bit insn into the 32-bit insn it stands for,
+// like rvee-rvc.sv does. Reserved and floating-point encodings expand
+// to 0, which is illegal.
+static inline uint32_t rv_rvc_expand(uint16_t c)
+{
+	uint32_t rd = (c >> 7) & 31;
+	uint32_t rs2 = (c >> 2) & 31;
+	uint32_t rdp = 8 + ((c >> 2) & 7);
+	uint32_t rs1p = 8 + ((c >> 7) & 7);
+	uint32_t imm6 = rv_sext(6, ((c >> 12) & 1) << 5 | ((c >> 2) & 31));
+	uint32_t imm;
+
+	switch ((c >> 13) << 2 | (c & 3)) {
+	// Quadrant 0.
+	case 0x00: // C.ADDI4SPN
+		imm = ((c >> 7) & 0xf) << 6 | ((c >> 11) & 3) << 4 |
+			((c >> 5) & 1) << 3 | ((c >> 6) & 1) << 2;
+		if (!imm)
+			return 0;
+		return I_ALU_TYPE | rdp << 7 | 2 << 15 | imm << 20;
+	case 0x08: // C.LW
+	case 0x18: // C.SW
+		imm = ((c >> 5) & 1) << 6 | ((c >> 10) & 7) << 3 |
+			((c >> 6) & 1) << 2;
+		if (c & 0x8000)
+			return rvee_encode_s(rs1p, rdp, 2, imm);
+		return I_LD_TYPE | rdp << 7 | 2 << 12 | rs1p << 15 | imm << 20;
+	// Quadrant 1.
+	case 0x01: // C.ADDI
+		return I_ALU_TYPE | rd << 7 | rd << 15 | imm6 << 20;
+	case 0x05: // C.JAL
+	case 0x15: // C.J
+		imm = ((c >> 12) & 1) << 11 | ((c >> 8) & 1) << 10 |
+			((c >> 9) & 3) << 8 | ((c >> 6) & 1) << 7 |
+			((c >> 7) & 1) << 6 | ((c >> 2) & 1) << 5 |
+			((c >> 11) & 1) << 4 | ((c >> 3) & 7) << 1;
+		return rvee_encode_jal(c & 0x8000 ? 0 : 1,
+				       rv_sext(12, imm) & 0x1fffff);
+	case 0x09: // C.LI
+		return I_ALU_TYPE | rd << 7 | imm6 << 20;
+	case 0x0d:
+		if (rd == 2) {
+			// C.ADDI16SP
+			imm = ((c >> 12) & 1) << 9 | ((c >> 3) & 3) << 7 |
+				((c >> 5) & 1) << 6 | ((c >> 2) & 1) << 5 |
+				((c >> 6) & 1) << 4;
+			if (!imm)
+				return 0;
+			return I_ALU_TYPE | 2 << 7 | 2 << 15 | rv_sext(10, imm) << 20;
+		}
+		// C.LUI
+		if (!imm6)
+			return 0;
+		return rvee_encode_u(LUI_TYPE, rd, imm6 << 12);
+	case 0x11:
+		switch ((c >> 10) & 3) {
+		case 0: // C.SRLI
+		case 1: // C.SRAI
+			if (c & 0x1000)
+				return 0;
+			imm = rs2 | ((c >> 10) & 1) << 10;
+			return I_ALU_TYPE | rs1p << 7 | ALU_SRL << 12 |
+				rs1p << 15 | imm << 20;
+		case 2: // C.ANDI
+			return I_ALU_TYPE | rs1p << 7 | ALU_AND << 12 |
+				rs1p << 15 | imm6 << 20;
+		default: {
+			// C.SUB, C.XOR, C.OR, C.AND
+			static const rv_alu_op_t ops[] = {
+				ALU_ADD, ALU_XOR, ALU_OR, ALU_AND,
+			};
+			unsigned int i = (c >> 5) & 3;
+
+			if (c & 0x1000)
+				return 0;
+			return rvee_encode_r(ops[i], rs1p, rs1p, rdp, i == 0);
+		}
+		}
+	case 0x19: // C.BEQZ
+	case 0x1d: // C.BNEZ
+		imm = ((c >> 12) & 1) << 8 | ((c >> 5) & 3) << 6 |
+			((c >> 2) & 1) << 5 | ((c >> 10) & 3) << 3 |
+			((c >> 3) & 3) << 1;
+		return rvee_encode_bcc(rs1p, 0, c & 0x2000 ? CC_NE : CC_EQ,
+				       rv_sext(9, imm) & 0x1fff);
+	// Quadrant 2.
+	case 0x02: // C.SLLI
+		if (c & 0x1000)
+			return 0;
+		return I_ALU_TYPE | rd << 7 | ALU_SLL << 12 | rd << 15 | rs2 << 20;
+	case 0x0a: // C.LWSP
+		imm = ((c >> 2) & 3) << 6 | ((c >> 12) & 1) << 5 |
+			((c >> 4) & 7) << 2;
+		if (!rd)
+			return 0;
+		return I_LD_TYPE | rd << 7 | 2 << 12 | 2 << 15 | imm << 20;
+	case 0x12:
+		if (rs2) {
+			// C.MV, C.ADD
+			return rvee_encode_r(ALU_ADD, rd, c & 0x1000 ? rd : 0,
+					     rs2, false);
+		}
+		if (rd) {
+			// C.JR, C.JALR
+			return I_JALR_TYPE | ((c >> 12) & 1) << 7 | rd << 15;
+		}
+		// C.EBREAK
+		return c & 0x1000 ? 0x00100073 : 0;
+	case 0x1a: // C.SWSP
+		imm = ((c >> 7) & 3) << 6 | ((c >> 9) & 0xf) << 2;
+		return rvee_encode_s(2, rs2, 2, imm);
+	default:
+		return 0;
+	}
+}
+#endif
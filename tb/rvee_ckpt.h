@@ -0,0 +1,199 @@
+/*
+ * Checkpoints for the RVee C++ harness.
+ *
+ * A checkpoint holds the Verilated model (built with --savable), the
+ * harness and device model state and the contents of the memory
+ * regions. Only the non-zero pages of a region are kept, each one
+ * preceded by its offset. Harnesses move their own state with io(),
+ * in the same order on save and restore.
+ *
+ * Checkpoints are only good for the same model and memory map.
+ * Verilator checks the former, mem() the latter.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_CKPT_H__
+#define __TB_RVEE_CKPT_H__
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "verilated_save.h"
+#include "rvee_soc.h"
+
+#define RVEE_CKPT_MAGIC		0x74706b6365657672ULL	// "rveeckpt"
+#define RVEE_CKPT_VERSION	1
+#define RVEE_CKPT_PAGE		4096
+#define RVEE_CKPT_END		(~0ULL)
+
+class rvee_ckpt_save {
+public:
+	// Pages written, for the log.
+	uint64_t pages;
+
+	rvee_ckpt_save() : pages(0) {}
+
+	bool open(const char *filename) {
+		uint64_t hdr[2] = { RVEE_CKPT_MAGIC, RVEE_CKPT_VERSION };
+
+		os.open(filename);
+		if (!os.isOpen()) {
+			fprintf(stderr, "%s: cannot create checkpoint\n",
+				filename);
+			return false;
+		}
+		io(hdr, sizeof hdr);
+		return true;
+	}
+
+	void close(void) {
+		os.close();
+	}
+
+	void io(void *p, size_t len) {
+		os.write(p, len);
+	}
+
+	template<typename M>
+	void model(M *m) {
+		os << *m;
+	}
+
+	void mem(rvee_soc_memmap *mem) {
+		uint64_t n = mem->regions.size();
+		unsigned int i;
+
+		io(&n, sizeof n);
+		for (i = 0; i < n; i++) {
+			rvee_soc_region *r = &mem->regions[i];
+			uint64_t hdr[2] = { r->base, r->size };
+			uint64_t off;
+
+			io(hdr, sizeof hdr);
+			for (off = 0; off < r->size; off += RVEE_CKPT_PAGE) {
+				if (zero(r->buf + off)) {
+					continue;
+				}
+				io(&off, sizeof off);
+				io(r->buf + off, RVEE_CKPT_PAGE);
+				pages++;
+			}
+			off = RVEE_CKPT_END;
+			io(&off, sizeof off);
+		}
+	}
+
+private:
+	VerilatedSave os;
+
+	static bool zero(const uint8_t *p) {
+		const uint64_t *w = (const uint64_t *) p;
+		unsigned int i;
+
+		for (i = 0; i < RVEE_CKPT_PAGE / sizeof *w; i++) {
+			if (w[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+class rvee_ckpt_restore {
+public:
+	bool open(const char *filename) {
+		uint64_t hdr[2];
+
+		is.open(filename);
+		if (!is.isOpen()) {
+			fprintf(stderr, "%s: cannot open checkpoint\n",
+				filename);
+			return false;
+		}
+		io(hdr, sizeof hdr);
+		if (hdr[0] != RVEE_CKPT_MAGIC || hdr[1] != RVEE_CKPT_VERSION) {
+			fprintf(stderr, "%s: not a checkpoint\n", filename);
+			return false;
+		}
+		return true;
+	}
+
+	void close(void) {
+		is.close();
+	}
+
+	void io(void *p, size_t len) {
+		is.read(p, len);
+	}
+
+	template<typename M>
+	void model(M *m) {
+		is >> *m;
+	}
+
+	// Regions are cleared first, anything loaded into them before
+	// the restore is dropped.
+	bool mem(rvee_soc_memmap *mem) {
+		uint64_t n;
+		unsigned int i;
+
+		io(&n, sizeof n);
+		if (n != mem->regions.size()) {
+			return mismatch();
+		}
+		for (i = 0; i < n; i++) {
+			rvee_soc_region *r = &mem->regions[i];
+			uint64_t hdr[2];
+			uint64_t off;
+
+			io(hdr, sizeof hdr);
+			if (hdr[0] != r->base || hdr[1] != r->size) {
+				return mismatch();
+			}
+			mem->clear(r);
+			for (;;) {
+				io(&off, sizeof off);
+				if (off == RVEE_CKPT_END) {
+					break;
+				}
+				if (off >= r->size || off % RVEE_CKPT_PAGE) {
+					fprintf(stderr, "checkpoint: bad page "
+						"0x%" PRIx64 "\n", off);
+					return false;
+				}
+				io(r->buf + off, RVEE_CKPT_PAGE);
+			}
+		}
+		return true;
+	}
+
+private:
+	VerilatedRestore is;
+
+	static bool mismatch(void) {
+		fprintf(stderr, "checkpoint: memory map differs from +mem\n");
+		return false;
+	}
+};
+#endif
@@ -40,6 +40,7 @@ using namespace sc_dt;
 using namespace std;
 
 #include "rvee.h"
+#include "utils.h"
 #include "trace/trace.h"
 #include "Vrvee_decode_tb.h"
 #include "verilated_vcd_sc.h"
@@ -74,6 +75,8 @@ SC_MODULE(Top)
 	sc_signal<bool> f_ready;
 	sc_signal<sc_bv<32> > f_iw;
 	sc_signal<sc_bv<32> > f_pc;
+	sc_signal<bool> f_pred;
+	sc_signal<bool> f_rvc;
 
 	sc_signal<bool> d_valid;
 	sc_signal<bool> d_ready;
@@ -94,6 +97,13 @@ SC_MODULE(Top)
 	sc_signal<sc_bv<XLEN> > d_jmp_offset;
 	sc_signal<bool> d_bcc;
 	sc_signal<bool> d_bcc_n;
+	sc_signal<bool> d_pred;
+	sc_signal<bool> d_jal;
+
+	sc_signal<bool> p_pjmp;
+	sc_signal<sc_bv<XLEN> > p_pjmp_base;
+	sc_signal<sc_bv<XLEN> > p_pjmp_offset;
+	sc_signal<sc_bv<2> > bpred;
 
 	unsigned int rand_seed;
 
@@ -123,6 +133,15 @@ SC_MODULE(Top)
 		bool bcc_n;
 		uint32_t imm;
 
+		// From fetch, BTB hit and RV32C.
+		bool f_pred;
+		bool rvc;
+		// Expected prediction and redirect.
+		bool pred;
+		bool jal;
+		bool pjmp;
+		xlen_t pjmp_offset;
+
 		rv_cc_t cc;
 	};
 	sc_fifo<payload *> queue;
@@ -141,7 +160,27 @@ SC_MODULE(Top)
 	}
 
 	void fetch(void) {
+		// Directed cases first: JALs with and without a BTB hit,
+		// backward (BTFN taken) and forward branches with and without
+		// one, and a BTB hit on something that isn't a jump.
+		static const struct {
+			int kind;
+			bool btb_hit;
+			bool backward;
+		} directed[] = {
+			{ INSN_JAL, 0, 0 },
+			{ INSN_JAL, 1, 0 },
+			{ INSN_BCC, 0, 1 },
+			{ INSN_BCC, 0, 0 },
+			{ INSN_BCC, 1, 1 },
+			{ INSN_BCC, 1, 0 },
+			{ INSN_R_ALU, 1, 0 },
+		};
 		const char *kind_names[INSN_MAX];
+		unsigned int n = 0;
+		unsigned int bpred;
+		xlen_t ilen;
+		int backward;
 		payload *p;
 
 		kind_names[INSN_R_ALU] = "r-alu";
@@ -155,10 +194,23 @@ SC_MODULE(Top)
 		kind_names[INSN_AUIPC] = "auipc";
 
 		wait(rst.negedge_event());
+		bpred = this->bpred.read().to_uint();
 		while (true) {
 			p = new payload();
 
 			p->kind = rand_r(&rand_seed) % INSN_MAX;
+			p->f_pred = (rand_r(&rand_seed) & 3) == 0;
+			backward = -1;
+			if (n < sizeof directed / sizeof directed[0]) {
+				p->kind = directed[n].kind;
+				p->f_pred = directed[n].btb_hit;
+				backward = directed[n].backward;
+				n++;
+			}
+			// Only BPRED 2 has a BTB.
+			p->f_pred &= bpred == 2;
+			p->rvc = rand_r(&rand_seed) & 1;
+			ilen = p->rvc ? 2 : 4;
 
 			p->pc = rand_r(&rand_seed) & ~3;
 			p->op = (rv_alu_op_t)(rand_r(&rand_seed) & 7);
@@ -168,6 +220,7 @@ SC_MODULE(Top)
 			p->imm = rand_r(&rand_seed);
 			p->rd_we = 0;
 			p->jmp = 0;
+			p->jal = 0;
 			p->bcc = 0;
 			p->bcc_n = 0;
 			p->a = 0;
@@ -178,7 +231,7 @@ SC_MODULE(Top)
 			p->jmp_base = 0;
 			p->jmp_offset = 0;
 
-			printf("%s:\n", kind_names[p->kind]);
+			TB_LOG(TB_LOG_DEBUG, "%s:\n", kind_names[p->kind]);
 			switch (p->kind) {
 			case INSN_LUI: {
 				p->imm &= ~0xfff;
@@ -197,6 +250,10 @@ SC_MODULE(Top)
 				};
 				p->imm &= ~1;
 				p->imm &= 0x1fff;
+				if (backward >= 0) {
+					p->imm &= ~0x1000;
+					p->imm |= backward << 12;
+				}
 				p->jmp_base = p->pc;
 				p->jmp_offset = rv_sext(13, p->imm);
 
@@ -228,7 +285,7 @@ SC_MODULE(Top)
 					break;
 				}
 
-				printf("BCC cc=%d imm=%x\n", p->cc, p->imm);
+				TB_LOG(TB_LOG_DEBUG, "BCC cc=%d imm=%x\n", p->cc, p->imm);
 				p->iw = rvee_encode_bcc(p->rs1, p->rs2, p->cc, p->imm);
 				break;
 			}
@@ -238,11 +295,13 @@ SC_MODULE(Top)
 				p->rd_we = 1;
 				p->op = ALU_ADD;
 				p->a = p->pc;
-				p->b = 4;
+				p->b = ilen;
 				p->c = 0;
 				p->jmp_base = p->pc;
 				p->jmp_offset = rv_sext(21, p->imm);
-				p->jmp = 1;
+				// With branch prediction DECODE redirects.
+				p->jmp = bpred == 0;
+				p->jal = 1;
 				p->iw = rvee_encode_jal(p->rd, p->imm);
 				break;
 			}
@@ -251,7 +310,7 @@ SC_MODULE(Top)
 				p->rd_we = 1;
 				p->op = ALU_ADD;
 				p->a = p->pc;
-				p->b = 4;
+				p->b = ilen;
 				p->c = 0;
 				p->jmp_base = p->pc;
 				p->jmp_offset = rv_sext(12, p->imm);
@@ -320,18 +379,46 @@ SC_MODULE(Top)
 				break;
 			}
 
+			// Branch prediction, see BPRED in rvee-config.svh.
+			// Fetch following the BTB needs no redirect, unless it
+			// hit on something that isn't a branch or a JAL.
+			p->pred = 0;
+			p->pjmp = 0;
+			p->pjmp_offset = p->jmp_offset;
+			if (bpred != 0 && p->f_pred) {
+				p->pred = p->bcc;
+				p->pjmp = !p->bcc && !p->jal;
+				p->pjmp_offset = ilen;
+			} else if (bpred != 0) {
+				p->pred = p->bcc && (p->iw >> 31);
+				p->pjmp = p->jal || p->pred;
+			}
+
 			queue.write(p);
 
-			printf("FETCH: pc=%lx iw=%x\n", (uint64_t) p->pc, p->iw);
+			TB_LOG(TB_LOG_DEBUG, "FETCH: pc=%lx iw=%x pred=%d rvc=%d\n",
+				(uint64_t) p->pc, p->iw, p->f_pred, p->rvc);
 
 			f_pc.write(p->pc);
 			f_iw.write(p->iw);
+			f_pred.write(p->f_pred);
+			f_rvc.write(p->rvc);
 			f_valid.write(1);
 			wait(clk.posedge_event());
 			while (f_ready.read() == 0) {
 				wait(clk.posedge_event());
 			}
 
+			// DECODE redirects in the cycle it takes the insn.
+			TB_LOG(TB_LOG_DEBUG, "FETCH: pjmp=%d.%d offset=%x.%x\n",
+				p_pjmp.read(), p->pjmp,
+				p_pjmp_offset.read().to_uint(), p->pjmp_offset);
+			sc_assert(p_pjmp.read() == p->pjmp);
+			if (p->pjmp) {
+				sc_assert(p_pjmp_base.read().to_uint() == p->pc);
+				sc_assert(p_pjmp_offset.read().to_uint() == p->pjmp_offset);
+			}
+
 			/* Apply randomized delay.  */
 			f_valid.write(0);
 			wait_rand_cycles();
@@ -354,6 +441,8 @@ SC_MODULE(Top)
 		xlen_t jmp_offset;
 		bool bcc;
 		bool bcc_n;
+		bool pred;
+		bool jal;
 		payload *p;
 
 		wait(rst.negedge_event());
@@ -381,10 +470,12 @@ SC_MODULE(Top)
 			jmp_offset = d_jmp_offset.read().to_uint();
 			bcc = d_bcc.read();
 			bcc_n = d_bcc_n.read();
+			pred = d_pred.read();
+			jal = d_jal.read();
 
 			p = queue.read();
 
-			printf("EX: pc=%lx op=%x rd_we=%d.%d rd=%d.%d a=%lx.%lx b=%lx.%lx c%d.%d sra=%d.%d ld=%d.%d st=%d.%d jb=%lx.%lx jo=%lx.%lx\n",
+			TB_LOG(TB_LOG_DEBUG, "EX: pc=%lx op=%x rd_we=%d.%d rd=%d.%d a=%lx.%lx b=%lx.%lx c%d.%d sra=%d.%d ld=%d.%d st=%d.%d jb=%lx.%lx jo=%lx.%lx\n",
 				(uint64_t)pc, op, rd_we, p->rd_we, rd, p->rd,
 				(uint64_t) a, (uint64_t) p->a,
 				(uint64_t) b, (uint64_t) p->b,
@@ -401,6 +492,8 @@ SC_MODULE(Top)
 				sc_assert(p->rd == rd);
 			sc_assert(p->jmp == jmp);
 			sc_assert(p->bcc == bcc);
+			sc_assert(p->pred == pred);
+			sc_assert(p->jal == jal);
 			sc_assert(p->mem_load == mem_load);
 			sc_assert(p->mem_store == mem_store);
 
@@ -419,8 +512,8 @@ SC_MODULE(Top)
 				sc_assert(p->bcc_n == bcc_n);
 				break;
 			case INSN_JAL:
-				sc_assert(p->a == p->pc);
-				sc_assert(p->b == 4);
+				sc_assert(p->a == a);
+				sc_assert(p->b == b);
 				sc_assert(p->c == 0);
 				sc_assert(p->jmp_base == jmp_base);
 				sc_assert(p->jmp_offset == jmp_offset);
@@ -459,6 +552,7 @@ SC_MODULE(Top)
 			}
 
 			delete p;
+			tb_transaction_done();
 
 			/* Apply randomized delay.  */
 			d_ready.write(0);
@@ -487,6 +581,8 @@ SC_MODULE(Top)
 		f_ready("f_ready"),
 		f_iw("f_iw"),
 		f_pc("f_pc"),
+		f_pred("f_pred"),
+		f_rvc("f_rvc"),
 		d_valid("d_valid"),
 		d_ready("d_ready"),
 		d_pc("d_pc"),
@@ -506,6 +602,12 @@ SC_MODULE(Top)
 		d_jmp_offset("d_jmp_offset"),
 		d_bcc("d_bcc"),
 		d_bcc_n("d_bcc_n"),
+		d_pred("d_pred"),
+		d_jal("d_jal"),
+		p_pjmp("p_pjmp"),
+		p_pjmp_base("p_pjmp_base"),
+		p_pjmp_offset("p_pjmp_offset"),
+		bpred("bpred"),
 		rand_seed(rand_seed)
 	{
 		m_qk.set_global_quantum(quantum);
@@ -528,6 +630,8 @@ SC_MODULE(Top)
 		tb.f_ready(f_ready);
 		tb.f_iw(f_iw);
 		tb.f_pc(f_pc);
+		tb.f_pred(f_pred);
+		tb.f_rvc(f_rvc);
 
 		tb.d_valid(d_valid);
 		tb.d_ready(d_ready);
@@ -548,6 +652,13 @@ SC_MODULE(Top)
 		tb.d_jmp_offset(d_jmp_offset);
 		tb.d_bcc(d_bcc);
 		tb.d_bcc_n(d_bcc_n);
+		tb.d_pred(d_pred);
+		tb.d_jal(d_jal);
+
+		tb.p_pjmp(p_pjmp);
+		tb.p_pjmp_base(p_pjmp_base);
+		tb.p_pjmp_offset(p_pjmp_offset);
+		tb.bpred(bpred);
 	}
 
 private:
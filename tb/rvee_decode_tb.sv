@@ -14,6 +14,8 @@ module rvee_decode_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	output	f_ready,
 	input	[31:0] f_iw,
 	input	[XLEN - 1:0] f_pc,
+	input	f_pred,
+	input	f_rvc,
 
 	input	meip, msip, mtip,
 	input	seip, ssip, stip,
@@ -36,7 +38,14 @@ module rvee_decode_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	output	[XLEN - 1:0] d_jmp_base,
 	output	[XLEN - 1:0] d_jmp_offset,
 	output	d_bcc,
-	output	d_bcc_n
+	output	d_bcc_n,
+	output	d_pred,
+	output	d_jal,
+
+	output	p_pjmp,
+	output	[XLEN - 1:0] p_pjmp_base,
+	output	[XLEN - 1:0] p_pjmp_offset,
+	output	[1:0] bpred
 	);
 
 	rvee_rf_if rf_if(.*);
@@ -55,11 +64,26 @@ module rvee_decode_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	rf_if.wb_rd = 0;
 	assign	rf_if.wb_data = 0;
 
+	// Nothing retires in this testbench.
+	assign	csr_if.ev_retire = 0;
+	assign	csr_if.ev_trap = 0;
+	assign	csr_if.ev_mem_wait = 0;
+	assign	csr_if.ev_redirect = 0;
+	assign	csr_if.ev_ic_hit = 0;
+	assign	csr_if.ev_ic_miss = 0;
+	assign	csr_if.ev_dc_hit = 0;
+	assign	csr_if.ev_dc_miss = 0;
+	assign	csr_if.ev_dc_evict = 0;
+	assign	mem_if.sb_empty = 1;
+	assign	mem_if.dc_clean = 1;
+
 	// Connect the interface to the outside world.
 	assign	fetch_if.valid = f_valid;
 	assign	f_ready = fetch_if.ready;
 	assign	fetch_if.iw = f_iw;
 	assign	fetch_if.pc = f_pc;
+	assign	fetch_if.pred = f_pred;
+	assign	fetch_if.rvc = f_rvc;
 
 	assign	d_valid = decode_if.valid;
 	assign	decode_if.ready = d_ready;
@@ -80,4 +104,16 @@ module rvee_decode_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	d_jmp_offset = decode_if.jmp_offset;
 	assign	d_bcc = decode_if.bcc;
 	assign	d_bcc_n = decode_if.bcc_n;
+	assign	d_pred = decode_if.pred;
+	assign	d_jal = decode_if.jal;
+
+	// No EX or PCGEN, so nothing flushes DECODE.
+	assign	pcgen_if.jmp = 0;
+	assign	pcgen_if.jmp_ff = 0;
+	assign	pcgen_if.jmp_out = 0;
+	assign	pcgen_if.bcc = 0;
+	assign	p_pjmp = pcgen_if.pjmp;
+	assign	p_pjmp_base = pcgen_if.pjmp_base;
+	assign	p_pjmp_offset = pcgen_if.pjmp_offset;
+	assign	bpred = `RVEE_CONFIG_BPRED;
 endmodule
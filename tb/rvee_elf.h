@@ -0,0 +1,281 @@
+/*
+ * ELF image loader for the RVee testbenches.
+ *
+ * PT_LOAD segments are placed at their physical address. Whole pages
+ * of file data are mapped copy-on-write straight from the file when
+ * the file offset and the address agree modulo the page size and the
+ * buffer is an anonymous mapping (see rvee_soc_memmap), the rest is
+ * copied.
+ * Memory past the file data of a segment (.bss) is zeroed.
+ *
+ * The entry point and the symbol table (e.g tohost) are kept around
+ * for the harnesses.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_ELF_H__
+#define __TB_RVEE_ELF_H__
+
+#include <elf.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+
+class rvee_elf {
+public:
+	uint64_t entry;
+	std::map<std::string, uint64_t> syms;
+	// Segments loaded so far, pages mapped from the file and bytes
+	// copied, for the log.
+	unsigned int loaded;
+	uint64_t mapped;
+	uint64_t copied;
+
+	rvee_elf() :
+		entry(0),
+		loaded(0),
+		mapped(0),
+		copied(0),
+		fd(-1),
+		file(NULL),
+		file_size(0) {
+	}
+
+	~rvee_elf() {
+		close();
+	}
+
+	// True if filename starts with the ELF magic.
+	static bool probe(const char *filename) {
+		unsigned char ident[SELFMAG];
+		FILE *fp = fopen(filename, "rb");
+		bool r;
+
+		if (!fp) {
+			return false;
+		}
+		r = fread(ident, sizeof ident, 1, fp) == 1 &&
+		    !memcmp(ident, ELFMAG, SELFMAG);
+		fclose(fp);
+		return r;
+	}
+
+	bool open(const char *filename) {
+		struct stat st;
+
+		fname = filename;
+		fd = ::open(filename, O_RDONLY);
+		if (fd < 0 || fstat(fd, &st) < 0) {
+			perror(filename);
+			return false;
+		}
+		file_size = st.st_size;
+		file = (const uint8_t *) mmap(NULL, file_size, PROT_READ,
+					      MAP_PRIVATE, fd, 0);
+		if (file == MAP_FAILED) {
+			file = NULL;
+			perror(filename);
+			return false;
+		}
+
+		ehdr = (const Elf32_Ehdr *) file;
+		if (file_size < sizeof *ehdr ||
+		    memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+		    ehdr->e_ident[EI_CLASS] != ELFCLASS32 ||
+		    ehdr->e_ident[EI_DATA] != ELFDATA2LSB ||
+		    ehdr->e_machine != EM_RISCV) {
+			fprintf(stderr, "%s: not a little-endian RV32 ELF\n",
+				filename);
+			return false;
+		}
+		if (!in_file(ehdr->e_phoff,
+			     (uint64_t) ehdr->e_phnum * sizeof(Elf32_Phdr)) ||
+		    !in_file(ehdr->e_shoff,
+			     (uint64_t) ehdr->e_shnum * sizeof(Elf32_Shdr))) {
+			fprintf(stderr, "%s: truncated ELF headers\n", filename);
+			return false;
+		}
+		phdr = (const Elf32_Phdr *) (file + ehdr->e_phoff);
+		shdr = (const Elf32_Shdr *) (file + ehdr->e_shoff);
+		entry = ehdr->e_entry;
+		return read_syms();
+	}
+
+	void close(void) {
+		if (file) {
+			munmap((void *) file, file_size);
+			file = NULL;
+		}
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+
+	// Number of PT_LOAD segments with memory.
+	unsigned int segments(void) const {
+		unsigned int i, n = 0;
+
+		for (i = 0; i < ehdr->e_phnum; i++) {
+			n += phdr[i].p_type == PT_LOAD && phdr[i].p_memsz;
+		}
+		return n;
+	}
+
+	// Load the segments that start in [base, base + size) into buf,
+	// which backs that range, and count them in loaded. can_map
+	// allows mapping file pages over parts of buf, which then must
+	// be page aligned and come from mmap.
+	bool load(uint8_t *buf, uint64_t base, uint64_t size, bool can_map) {
+		uint64_t pgsz = sysconf(_SC_PAGESIZE);
+		unsigned int i;
+
+		for (i = 0; i < ehdr->e_phnum; i++) {
+			const Elf32_Phdr *p = &phdr[i];
+			uint64_t addr = p->p_paddr;
+			uint64_t off = p->p_offset;
+			uint64_t len = p->p_filesz;
+			uint64_t skip, n;
+
+			if (p->p_type != PT_LOAD || p->p_memsz == 0 ||
+			    addr < base || addr - base >= size) {
+				continue;
+			}
+			if (addr - base + p->p_memsz > size ||
+			    p->p_filesz > p->p_memsz || !in_file(off, len)) {
+				fprintf(stderr, "%s: segment %u at 0x%" PRIx64
+					" size 0x%x does not fit in memory\n",
+					fname.c_str(), i, addr, p->p_memsz);
+				return false;
+			}
+
+			// Copy up to the first page boundary, map the whole
+			// pages and copy the tail.
+			if (can_map && (addr - base) % pgsz == off % pgsz) {
+				skip = (pgsz - off % pgsz) % pgsz;
+				skip = skip > len ? len : skip;
+				copy(buf, addr - base, off, skip);
+				addr += skip;
+				off += skip;
+				len -= skip;
+
+				n = len - len % pgsz;
+				if (n && mmap(buf + (addr - base), n,
+					      PROT_READ | PROT_WRITE,
+					      MAP_PRIVATE | MAP_FIXED,
+					      fd, off) != MAP_FAILED) {
+					mapped += n / pgsz;
+					addr += n;
+					off += n;
+					len -= n;
+				}
+			}
+			copy(buf, addr - base, off, len);
+
+			// .bss
+			memset(buf + (p->p_paddr - base) + p->p_filesz, 0,
+			       p->p_memsz - p->p_filesz);
+			loaded++;
+		}
+		return true;
+	}
+
+	bool sym(const char *name, uint64_t *addr) const {
+		std::map<std::string, uint64_t>::const_iterator it;
+
+		it = syms.find(name);
+		if (it == syms.end()) {
+			return false;
+		}
+		*addr = it->second;
+		return true;
+	}
+
+private:
+	std::string fname;
+	int fd;
+	const uint8_t *file;
+	uint64_t file_size;
+	const Elf32_Ehdr *ehdr;
+	const Elf32_Phdr *phdr;
+	const Elf32_Shdr *shdr;
+
+	bool in_file(uint64_t off, uint64_t len) const {
+		return off <= file_size && len <= file_size - off;
+	}
+
+	void copy(uint8_t *buf, uint64_t dst, uint64_t off, uint64_t len) {
+		memcpy(buf + dst, file + off, len);
+		copied += len;
+	}
+
+	// Named symbols from .symtab. Stripped images have none.
+	bool read_syms(void) {
+		unsigned int i, j;
+
+		for (i = 0; i < ehdr->e_shnum; i++) {
+			const Elf32_Shdr *s = &shdr[i];
+			const Elf32_Shdr *str;
+			const Elf32_Sym *sym;
+			const char *strtab;
+
+			if (s->sh_type != SHT_SYMTAB) {
+				continue;
+			}
+			if (s->sh_link >= ehdr->e_shnum) {
+				break;
+			}
+			str = &shdr[s->sh_link];
+			// The string table must be in the file and terminated.
+			if (!in_file(s->sh_offset, s->sh_size) ||
+			    !in_file(str->sh_offset, str->sh_size) ||
+			    str->sh_size == 0 ||
+			    file[str->sh_offset + str->sh_size - 1]) {
+				fprintf(stderr, "%s: truncated symbol table\n",
+					fname.c_str());
+				return false;
+			}
+
+			sym = (const Elf32_Sym *) (file + s->sh_offset);
+			strtab = (const char *) file + str->sh_offset;
+			for (j = 0; j < s->sh_size / sizeof *sym; j++) {
+				if (sym[j].st_name == 0 ||
+				    sym[j].st_name >= str->sh_size ||
+				    sym[j].st_shndx == SHN_UNDEF ||
+				    ELF32_ST_TYPE(sym[j].st_info) == STT_SECTION ||
+				    ELF32_ST_TYPE(sym[j].st_info) == STT_FILE) {
+					continue;
+				}
+				syms[strtab + sym[j].st_name] = sym[j].st_value;
+			}
+		}
+		return true;
+	}
+};
+#endif
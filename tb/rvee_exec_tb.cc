@@ -67,6 +67,7 @@ SC_MODULE(Top)
 	sc_signal<bool> d_c;
 	sc_signal<bool> d_msb_xor;
 	sc_signal<bool> d_sra;
+	sc_signal<bool> d_muldiv;
 	sc_signal<bool> d_mem_load;
 	sc_signal<bool> d_mem_store;
 	sc_signal<sc_bv<2> > d_mem_size;
@@ -76,6 +77,9 @@ SC_MODULE(Top)
 	sc_signal<sc_bv<XLEN> > d_jmp_offset;
 	sc_signal<bool> d_bcc;
 	sc_signal<bool> d_bcc_n;
+	sc_signal<bool> d_pred;
+	sc_signal<bool> d_rvc;
+	sc_signal<bool> d_jal;
 
 	sc_signal<bool> p_jmp;
 	sc_signal<bool> p_jmp_ff;
@@ -83,6 +87,9 @@ SC_MODULE(Top)
 	sc_signal<sc_bv<XLEN> > p_jmp_base;
 	sc_signal<sc_bv<XLEN> > p_jmp_offset;
 	sc_signal<sc_bv<XLEN> > p_pc;
+	sc_signal<bool> p_bp_we;
+	sc_signal<bool> p_bp_taken;
+	sc_signal<bool> p_bp_jal;
 
 	sc_signal<bool> e_valid;
 	sc_signal<bool> e_ready;
@@ -107,6 +114,8 @@ SC_MODULE(Top)
 		bool msb_xor;
 		bool sra;
 		rv_alu_op_t op;
+		// RV32M, op is funct3.
+		bool muldiv;
 
 		bool mem_load;
 		bool mem_store;
@@ -119,6 +128,10 @@ SC_MODULE(Top)
 		int jmp_offset;
 		bool bcc;
 		bool bcc_n;
+		// Predicted taken by the BTB, expanded from RV32C, a JAL.
+		bool pred;
+		bool rvc;
+		bool jal;
 
 		bool next_jmp_bcc;
 	};
@@ -145,10 +158,15 @@ SC_MODULE(Top)
 		int op_max[2];
 
 		bool do_mem;
+		bool do_muldiv;
 		bool do_jmp_bcc;
 		bool next_jmp_bcc;
 	} setup;
 
+	// The first 8 insns are branches, one for each combination of
+	// predicted taken, actually taken and RV32C (bits 0 - 2).
+	unsigned int directed;
+
 	void prep_setup(void) {
 		int i;
 
@@ -156,8 +174,14 @@ SC_MODULE(Top)
 		setup.negated_ops = (rand_r(&rand_seed) & 7) == 0;
 		setup.complemented_ops = (rand_r(&rand_seed) & 7) == 0;
 		setup.do_mem = (rand_r(&rand_seed) & 3) == 0;
+		setup.do_muldiv = (rand_r(&rand_seed) & 3) == 0;
 		setup.do_jmp_bcc = setup.next_jmp_bcc;
 		setup.next_jmp_bcc = (rand_r(&rand_seed) & 7) == 0;
+		if (directed < 8) {
+			setup.do_mem = 0;
+			setup.do_jmp_bcc = 1;
+			setup.next_jmp_bcc = 1;
+		}
 
 		for (i = 0; i < 2; i++) {
 			setup.op_zero[i] = (rand_r(&rand_seed) & 7) == 0;
@@ -167,7 +191,7 @@ SC_MODULE(Top)
 //		setup.do_mem = 0;
 //		setup.do_jmp_bcc = 0;
 
-		printf("eq=%d neg=%d compl=%d\n",
+		TB_LOG(TB_LOG_DEBUG, "eq=%d neg=%d compl=%d\n",
 			setup.equal_ops, setup.negated_ops, setup.complemented_ops);
 	}
 
@@ -184,7 +208,7 @@ SC_MODULE(Top)
 
 		wait(rst.negedge_event());
 		while (true) {
-			printf("rand_seed=%x\n", rand_seed);
+			TB_LOG(TB_LOG_DEBUG, "rand_seed=%x\n", rand_seed);
 			prep_setup();
 
 			p = new payload();
@@ -192,7 +216,7 @@ SC_MODULE(Top)
 			p->rd_we = rand_r(&rand_seed) & 1;
 			p->rd = rand_r(&rand_seed) & 31;
 			p->op = (rv_alu_op_t) ((int)rand_r(&rand_seed) & 7);
-			printf("OP=%d\n", p->op);
+			TB_LOG(TB_LOG_DEBUG, "OP=%d\n", p->op);
 			p->a = gen_op(0);
 			if (setup.equal_ops)
 				p->b = p->a;
@@ -240,6 +264,9 @@ SC_MODULE(Top)
 				p->jmp = rand_r(&rand_seed) & 1;
 				p->bcc = !p->jmp;
 				p->bcc_n = rand_r(&rand_seed) & 1;
+				p->pred = p->bcc && (rand_r(&rand_seed) & 1);
+				p->rvc = rand_r(&rand_seed) & 1;
+				p->jal = p->jmp && (rand_r(&rand_seed) & 1);
 				p->c = p->bcc;
 
 				p->jmp_base = p->pc;
@@ -261,16 +288,40 @@ SC_MODULE(Top)
 						ALU_ADD, ALU_SLT, ALU_SLTU,
 					};
 					p->op = valid_ops[rand_r(&rand_seed) % 3];
-					printf("op=%x\n", p->op);
+					TB_LOG(TB_LOG_DEBUG, "op=%x\n", p->op);
 					if (p->op == ALU_ADD) {
 						/* SLT/SLTU prepped below.  */
 						p->b = ~p->b;
 						p->c = 1;
 					}
 				}
+
+				if (directed < 8) {
+					// BEQ, taken if b == a.
+					p->jmp = 0;
+					p->jal = 0;
+					p->bcc = 1;
+					p->bcc_n = 0;
+					p->pred = directed & 1;
+					p->rvc = directed & 4;
+					p->op = ALU_ADD;
+					p->org_b = directed & 2 ? p->a : p->a + 1;
+					p->b = ~p->org_b;
+					p->c = 1;
+					directed++;
+				}
+			} else if (setup.do_muldiv) {
+				p->muldiv = 1;
+				p->c = 0;
+				// DIV/REM overflow.
+				if ((rand_r(&rand_seed) & 7) == 0) {
+					p->a = (xlen_t) 1 << (XLEN - 1);
+					p->b = XLEN_MAX;
+					p->org_b = p->b;
+				}
 			}
 
-			switch (p->op) {
+			switch (p->muldiv ? ALU_ADD : p->op) {
 			case ALU_SLT:
 			case ALU_SLTU:
 				p->b = ~p->b;
@@ -290,6 +341,7 @@ SC_MODULE(Top)
 			d_c.write(p->c);
 			d_msb_xor.write(p->msb_xor);
 			d_sra.write(p->sra);
+			d_muldiv.write(p->muldiv);
 
 			d_mem_load.write(p->mem_load);
 			d_mem_store.write(p->mem_store);
@@ -301,9 +353,12 @@ SC_MODULE(Top)
 			d_jmp_base.write(p->jmp_base);
 			d_jmp_offset.write(p->jmp_offset);
 			d_bcc_n.write(p->bcc_n);
+			d_pred.write(p->pred);
+			d_rvc.write(p->rvc);
+			d_jal.write(p->jal);
 
 			queue.write(p);
-			printf("DEC: pc=%lx rd=%x op=%x a=%lx b=%lx org_b=%lx c=%d sra=%d "
+			TB_LOG(TB_LOG_DEBUG, "DEC: pc=%lx rd=%x op=%x a=%lx b=%lx org_b=%lx c=%d sra=%d "
 				"mem ld=%d st=%d sz=%d ext=%d jmp=%d bcc=%d.%d j-b-o=%lx.%lx\n\n",
 				(uint64_t) p->pc, p->rd, p->op,
 				(uint64_t) p->a, (uint64_t) p->b, (uint64_t) p->org_b,
@@ -339,6 +394,10 @@ SC_MODULE(Top)
 		bool jmp_out;
 		xlen_t jmp_base;
 		xlen_t jmp_offset;
+		xlen_t next_pc;
+		bool bp_we;
+		bool bp_taken;
+		bool bp_jal;
 		payload *p;
 
 		wait(rst.negedge_event());
@@ -364,8 +423,14 @@ SC_MODULE(Top)
 			jmp_out = p_jmp_out.read();
 			jmp_base = p_jmp_base.read().to_uint();
 			jmp_offset = p_jmp_offset.read().to_uint();
-
-			switch (p->op) {
+			next_pc = p_pc.read().to_uint();
+			bp_we = p_bp_we.read();
+			bp_taken = p_bp_taken.read();
+			bp_jal = p_bp_jal.read();
+
+			// -1 stands for RV32M, op is then funct3.
+			switch (p->muldiv ? -1 : p->op) {
+			case -1: d = rv_muldiv(p->op, p->a, p->b); break;
 			case ALU_ADD: d = p->a + p->b + p->c; break;
 			case ALU_SLL: d = p->a << (p->b & (XLEN - 1)); break;
 			case ALU_SLT: {
@@ -382,7 +447,7 @@ SC_MODULE(Top)
 					hw_d = tmp;
 				}
 				hw_d >>= XLEN - 1;
-				printf("result=%d d=%d hw_d=%d a=%x b=%x.%x c=%d msb_xor=%x tmp=%x\n",
+				TB_LOG(TB_LOG_DEBUG, "result=%d d=%d hw_d=%d a=%x b=%x.%x c=%d msb_xor=%x tmp=%x\n",
 					result, d, hw_d, p->a, p->b, p->org_b, p->c,
 					p->msb_xor, tmp);
 				if (d != hw_d) {
@@ -405,7 +470,7 @@ SC_MODULE(Top)
 
 				tmp = (uint64_t) p->a + p->b + p->c;
 				hw_d = !(tmp & (1ULL << 32));
-				printf("a=%x b=%x c=%d d=%x hw_d=%x tmp=%lx\n",
+				TB_LOG(TB_LOG_DEBUG, "a=%x b=%x c=%d d=%x hw_d=%x tmp=%lx\n",
 					p->a, p->b, p->c, d, hw_d, tmp);
 				sc_assert(d == hw_d);
 				break;
@@ -423,7 +488,7 @@ SC_MODULE(Top)
 			default: d = 0; break;
 			}
 
-			printf("MEM: pc=%lx.%lx op=%d rd=%x result=%lx a=%lx b=%lx.%lx d=%lx c=%d sra=%d jmp_base=%lx jmp=%d.%d.%d\n",
+			TB_LOG(TB_LOG_DEBUG, "MEM: pc=%lx.%lx op=%d rd=%x result=%lx a=%lx b=%lx.%lx d=%lx c=%d sra=%d jmp_base=%lx jmp=%d.%d.%d\n",
 				(uint64_t) pc, (uint64_t) p->pc, p->op, rd, (uint64_t) result,
 				(uint64_t) p->a, (uint64_t) p->b, (uint64_t) p->org_b,
 				(uint64_t) d, p->c, p->sra, (uint64_t) jmp_base,
@@ -436,8 +501,17 @@ SC_MODULE(Top)
 				// random wait on the insn prior to the jump.
 				sc_assert(p->jmp == jmp_out);
 //				sc_assert(jmp_base + jmp_offset == (p->jmp_base + p->jmp_offset));
+
+				// JALs train the BTB.
+				sc_assert(bp_we == p->jal);
+				if (p->jal) {
+					sc_assert(bp_taken);
+					sc_assert(bp_jal);
+				}
 			} else if (p->bcc) {
 				bool taken;
+				bool mispredict;
+				xlen_t target;
 
 				switch (p->op) {
 				case ALU_ADD:
@@ -460,16 +534,31 @@ SC_MODULE(Top)
 
 				if (p->bcc_n)
 					taken = !taken;
+				mispredict = taken ^ p->pred;
 
-				printf("bcc taken=%d pc=%lx op=%d a=%x b=%x org_b=%x bcc_n=%d jmp=%d.%d j-base=%lx.%lx j-offset=%lx.%lx\n",
+				TB_LOG(TB_LOG_DEBUG, "bcc taken=%d pc=%lx op=%d a=%x b=%x org_b=%x bcc_n=%d jmp=%d.%d j-base=%lx.%lx j-offset=%lx.%lx\n",
 					taken, (uint64_t)pc, p->op, p->a, p->b, p->org_b, p->bcc_n, jmp, taken,
 					(uint64_t)jmp_base, (uint64_t)p->jmp_base,
 					(uint64_t)jmp_offset, (uint64_t)p->jmp_offset);
-				sc_assert(p_jmp_out.read() == taken);
+				// EX only redirects on mispredicts, predicted taken
+				// branches that fall through go to the next insn.
+				sc_assert(jmp_out == mispredict);
+				if (mispredict) {
+					target = p->jmp_base + p->jmp_offset;
+					if (p->pred) {
+						target = p->pc + (p->rvc ? 2 : 4);
+					}
+					TB_LOG(TB_LOG_DEBUG, "bcc pred=%d rvc=%d next_pc=%x target=%x\n",
+						p->pred, p->rvc, next_pc, target);
+					sc_assert(next_pc == (target & ~1));
+				}
+				sc_assert(bp_we);
+				sc_assert(bp_taken == taken);
+				sc_assert(!bp_jal);
 
 				// After a bcc we need to ignore the next insns since
 				// the EXEC stage will drop it.
-				if (taken && d_valid.read()) {
+				if (mispredict && d_valid.read()) {
 					payload *p;
 					p = queue.read();
 					delete p;
@@ -498,6 +587,7 @@ SC_MODULE(Top)
 				wait_rand_cycles();
 			}
 			delete p;
+			tb_transaction_done();
 		}
 	}
 
@@ -525,6 +615,7 @@ SC_MODULE(Top)
 		d_c("d_c"),
 		d_msb_xor("d_msb_xor"),
 		d_sra("d_sra"),
+		d_muldiv("d_muldiv"),
 		d_mem_load("d_mem_load"),
 		d_mem_store("d_mem_store"),
 		d_mem_size("d_mem_size"),
@@ -534,6 +625,9 @@ SC_MODULE(Top)
 		d_jmp_offset("d_jmp_offset"),
 		d_bcc("d_bcc"),
 		d_bcc_n("d_bcc_m"),
+		d_pred("d_pred"),
+		d_rvc("d_rvc"),
+		d_jal("d_jal"),
 
 		p_jmp("p_jmp"),
 		p_jmp_ff("p_jmp_ff"),
@@ -541,6 +635,9 @@ SC_MODULE(Top)
 		p_jmp_base("p_jmp_base"),
 		p_jmp_offset("p_jmp_offset"),
 		p_pc("p_pc"),
+		p_bp_we("p_bp_we"),
+		p_bp_taken("p_bp_taken"),
+		p_bp_jal("p_bp_jal"),
 
 		e_valid("e_valid"),
 		e_ready("e_ready"),
@@ -553,7 +650,8 @@ SC_MODULE(Top)
 		e_mem_data("e_mem_data"),
 		e_mem_size("e_mem_size"),
 		e_mem_sext("e_mem_sext"),
-		rand_seed(rand_seed)
+		rand_seed(rand_seed),
+		directed(0)
 	{
 		m_qk.set_global_quantum(quantum);
 
@@ -579,6 +677,7 @@ SC_MODULE(Top)
 		tb.d_c(d_c);
 		tb.d_msb_xor(d_msb_xor);
 		tb.d_sra(d_sra);
+		tb.d_muldiv(d_muldiv);
 		tb.d_mem_load(d_mem_load);
 		tb.d_mem_store(d_mem_store);
 		tb.d_mem_size(d_mem_size);
@@ -588,6 +687,9 @@ SC_MODULE(Top)
 		tb.d_jmp_offset(d_jmp_offset);
 		tb.d_bcc(d_bcc);
 		tb.d_bcc_n(d_bcc_n);
+		tb.d_pred(d_pred);
+		tb.d_rvc(d_rvc);
+		tb.d_jal(d_jal);
 
 		tb.p_jmp(p_jmp);
 		tb.p_jmp_ff(p_jmp_ff);
@@ -595,6 +697,9 @@ SC_MODULE(Top)
 		tb.p_jmp_base(p_jmp_base);
 		tb.p_jmp_offset(p_jmp_offset);
 		tb.p_pc(p_pc);
+		tb.p_bp_we(p_bp_we);
+		tb.p_bp_taken(p_bp_taken);
+		tb.p_bp_jal(p_bp_jal);
 
 		tb.e_valid(e_valid);
 		tb.e_ready(e_ready);
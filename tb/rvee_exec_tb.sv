@@ -20,6 +20,7 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	d_msb_xor,
 	input	d_c,
 	input	d_sra,
+	input	d_muldiv,
 	input	d_mem_load,
 	input	d_mem_store,
 	input	[1:0] d_mem_size,
@@ -28,6 +29,9 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	[XLEN - 1:0] d_jmp_base,
 	input	[XLEN - 1:0] d_jmp_offset,
 	input	d_bcc, d_bcc_n,
+	input	d_pred,
+	input	d_rvc,
+	input	d_jal,
 
 	output	p_jmp,
 	output	p_jmp_ff,
@@ -35,6 +39,9 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	output	[XLEN - 1:0] p_jmp_base,
 	output	[XLEN - 1:0] p_jmp_offset,
 	output	[XLEN - 1:0] p_pc,
+	output	p_bp_we,
+	output	p_bp_taken,
+	output	p_bp_jal,
 
 	output	e_valid,
 	input	e_ready,
@@ -71,6 +78,7 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	decode_if.c = d_c;
 	assign	decode_if.msb_xor = d_msb_xor;
 	assign	decode_if.sra = d_sra;
+	assign	decode_if.muldiv = d_muldiv;
 	assign	decode_if.mem_load = d_mem_load;
 	assign	decode_if.mem_store = d_mem_store;
 	assign	decode_if.mem_size = d_mem_size;
@@ -80,6 +88,12 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	decode_if.jmp_offset = d_jmp_offset;
 	assign	decode_if.bcc = d_bcc;
 	assign	decode_if.bcc_n = d_bcc_n;
+	assign	decode_if.pred = d_pred;
+	assign	decode_if.rvc = d_rvc;
+	assign	decode_if.jal = d_jal;
+	assign	pcgen_if.pjmp = 0;
+	// No FENCE.I without decode.
+	assign	pcgen_if.bp_inval = 0;
 
 	assign	p_jmp = pcgen_if.jmp;
 	assign	p_jmp_ff = pcgen_if.jmp_ff;
@@ -87,6 +101,9 @@ module rvee_exec_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	p_jmp_base = pcgen_if.jmp_base;
 	assign	p_jmp_offset = pcgen_if.jmp_offset;
 	assign	p_pc = pcgen_if.pc;
+	assign	p_bp_we = pcgen_if.bp_we;
+	assign	p_bp_taken = pcgen_if.bp_taken;
+	assign	p_bp_jal = pcgen_if.bp_jal;
 
 	assign	e_valid = exec_if.valid;
 	assign	exec_if.ready = e_ready;
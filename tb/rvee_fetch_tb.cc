@@ -39,7 +39,11 @@ using namespace sc_core;
 using namespace sc_dt;
 using namespace std;
 
+#include <deque>
+
 #include "rvee.h"
+#include "utils.h"
+#include "plusargs.h"
 
 #include "trace/trace.h"
 #include "Vrvee_fetch_tb.h"
@@ -68,6 +72,8 @@ SC_MODULE(Top)
 
 	AXILiteSignals<AWIDTH, DWIDTH> axi_signals;
 	axilite2tlm_bridge<AWIDTH, DWIDTH> tlm_bridge;
+	// The bridge sits idle on these in +mem-latency mode.
+	AXILiteSignals<AWIDTH, DWIDTH> idle_signals;
 	AXILiteProtocolChecker<AWIDTH, DWIDTH > checker;
 
 	sc_signal<bool> p_ready;
@@ -81,6 +87,7 @@ SC_MODULE(Top)
 	sc_signal<sc_bv<32> > f_iw;
 	sc_signal<sc_bv<XLEN> > f_pc;
 	sc_signal<bool> f_flush;
+	sc_signal<sc_bv<8> > f_depth;
 
 	class payload {
 	public:
@@ -92,6 +99,21 @@ SC_MODULE(Top)
 
 	unsigned int rand_seed;
 
+	// +mem-latency=N replaces the TLM bridge (which serves one read
+	// at a time) with a pipelined memory that answers every read
+	// N cycles after its AR handshake, and the decoder never stalls.
+	// Used to measure fetch throughput, see make fetch-sweep.
+	unsigned int mem_latency;
+	struct mem_req {
+		uint64_t due;
+		uint32_t iw;
+	};
+	std::deque<mem_req> mem_q;
+	uint64_t mem_now;
+
+	uint64_t cycles;
+	uint64_t insns;
+
 	SC_HAS_PROCESS(Top);
 
 	void wait_cycles(unsigned int n) {
@@ -101,8 +123,12 @@ SC_MODULE(Top)
 	}
 
 	void wait_rand_cycles(void) {
+		if (mem_latency) {
+			return;
+		}
+
 		unsigned int rand_delay = (rand_r(&rand_seed) & 0xf) + 1;
-		printf("%s: delay=%d\n", __func__, rand_delay);
+		TB_LOG(TB_LOG_DEBUG, "%s: delay=%d\n", __func__, rand_delay);
 		wait_cycles(rand_delay);
 	}
 
@@ -119,7 +145,7 @@ SC_MODULE(Top)
 
 		p->pc = addr;
 		p->iw = iw;
-		printf("AXI: pc=%lx iw=%x jmp_delay=%d jmp_dest=%x flush=%d\n",
+		TB_LOG(TB_LOG_DEBUG, "AXI: pc=%lx iw=%x jmp_delay=%d jmp_dest=%x flush=%d\n",
 			(uint64_t) p->pc, p->iw, jmp_delay, jmp_dest, flush);
 
 		queued_insns.write(p);
@@ -128,6 +154,57 @@ SC_MODULE(Top)
 		trans.set_response_status(tlm::TLM_OK_RESPONSE);
 	}
 
+	void pipe_mem(void) {
+		mem_req r;
+
+		if (rst.read()) {
+			mem_q.clear();
+			mem_now = 0;
+			axi_signals.arready.write(0);
+			axi_signals.rvalid.write(0);
+			return;
+		}
+
+		mem_now++;
+		if (axi_signals.rvalid.read() && axi_signals.rready.read()) {
+			mem_q.pop_front();
+		}
+		if (axi_signals.arvalid.read() && axi_signals.arready.read()) {
+			payload *p = new payload();
+
+			p->pc = axi_signals.araddr.read().to_uint();
+			p->iw = rand_r(&rand_seed);
+			r.due = mem_now + mem_latency - 1;
+			r.iw = p->iw;
+			mem_q.push_back(r);
+			// pipe_mem is a method and can't block, an overflow
+			// would silently desync the checker.
+			if (!queued_insns.nb_write(p)) {
+				TB_LOG(TB_LOG_ERR, "insn queue overflow pc=%lx\n",
+					(uint64_t) p->pc);
+				sc_assert(0);
+			}
+		}
+
+		axi_signals.arready.write(mem_q.size() < 16);
+		axi_signals.rvalid.write(!mem_q.empty() && mem_q.front().due <= mem_now);
+		axi_signals.rdata.write(mem_q.empty() ? 0 : mem_q.front().iw);
+		axi_signals.rresp.write(0);
+	}
+
+	void count_cycles(void) {
+		if (!rst.read()) {
+			cycles++;
+		}
+	}
+
+	void end_of_simulation(void) {
+		printf("fetch depth %u latency %u: %" PRIu64 " insns in %" PRIu64
+			" cycles, %.3f insns/cycle\n",
+			f_depth.read().to_uint(), mem_latency, insns, cycles,
+			cycles ? (double) insns / cycles : 0);
+	}
+
 	xlen_t jmp_dest;
 	int jmp_delay;
 	void decoder(void) {
@@ -154,7 +231,8 @@ SC_MODULE(Top)
 
 			p = queued_insns.read();
 			if (jmp_delay) {
-				int depth = 5;
+				// Wrong-path fetches that were in flight.
+				int depth = f_depth.read().to_uint() + 3;
 
 				while (p->pc != jmp_dest && depth > 0) {
 					delete p;
@@ -164,7 +242,7 @@ SC_MODULE(Top)
 				sc_assert(p->pc == jmp_dest);
 			}
 
-			printf("DECODER: pc=%lx.%lx prev_pc=%lx iw=%x.%x jmp_delay=%d\n",
+			TB_LOG(TB_LOG_DEBUG, "DECODER: pc=%lx.%lx prev_pc=%lx iw=%x.%x jmp_delay=%d\n",
 				(uint64_t) pc, (uint64_t) p->pc, (uint64_t) prev_pc, iw, p->iw,
 				jmp_delay);
 
@@ -180,12 +258,14 @@ SC_MODULE(Top)
 				sc_assert(p->iw == iw);
 
 				if (pc != prev_pc + 4) {
-					printf("BAD PC\n");
-					sc_stop();
+					TB_LOG(TB_LOG_ERR, "BAD PC\n");
+					sc_assert(0);
 				}
 			}
 			delete p;
 			p = NULL;
+			insns++;
+			tb_transaction_done();
 
 			/* Update PC, with randomized jumps.  */
 			jmp = 0;
@@ -199,7 +279,7 @@ SC_MODULE(Top)
 				jmp_offset = 0;
 				jmp_dest = jmp_base + jmp_offset;
 
-				printf("JMP to %lx (%lx + %lx) p-r%d\n",
+				TB_LOG(TB_LOG_DEBUG, "JMP to %lx (%lx + %lx) p-r%d\n",
 					(uint64_t) (jmp_base + jmp_offset),
 					(uint64_t) jmp_base, (uint64_t) jmp_offset,
 					p_ready.read());
@@ -220,7 +300,7 @@ SC_MODULE(Top)
 				wait(clk.posedge_event());
 				f_ready.write(0);
 				p_jmp.write(0);
-				printf("END JMP f_valid=%d jmp_ff=%d jmp=%d\n",
+				TB_LOG(TB_LOG_DEBUG, "END JMP f_valid=%d jmp_ff=%d jmp=%d\n",
 					f_valid.read(), p_jmp_ff.read(), p_jmp.read());
 				// dec stage is responsible for droping active insn when seeing
 				// a jmp.
@@ -228,10 +308,10 @@ SC_MODULE(Top)
 					p = queued_insns.read();
 					pc = f_pc.read().to_uint();
 
-					printf("GOT an insn while jumping %x.%x flush=%d\n",
+					TB_LOG(TB_LOG_DEBUG, "GOT an insn while jumping %x.%x flush=%d\n",
 						pc, p->pc, f_flush.read());
 					sc_assert(p->pc == pc); 
-					printf("Dropped pc %x\n", p->pc);
+					TB_LOG(TB_LOG_DEBUG, "Dropped pc %x\n", p->pc);
 					delete p;
 					f_ready.write(1);
 					wait(clk.posedge_event());
@@ -241,7 +321,7 @@ SC_MODULE(Top)
 					wait(clk.posedge_event());
 					f_ready.write(0);
 				}
-				printf("END2 JMP f_valid=%d jmp_ff=%d jmp=%d\n",
+				TB_LOG(TB_LOG_DEBUG, "END2 JMP f_valid=%d jmp_ff=%d jmp=%d\n",
 					f_valid.read(), p_jmp_ff.read(), p_jmp.read());
 				// dec stage is responsible for droping active insn when seeing
 				// a jmp_ff.
@@ -249,10 +329,10 @@ SC_MODULE(Top)
 					p = queued_insns.read();
 					pc = f_pc.read().to_uint();
 
-					printf("GOT an insn while jumping %x.%x flush=%d\n",
+					TB_LOG(TB_LOG_DEBUG, "GOT an insn while jumping %x.%x flush=%d\n",
 						pc, p->pc, f_flush.read());
 					sc_assert(p->pc == pc); 
-					printf("Dropped pc %x\n", p->pc);
+					TB_LOG(TB_LOG_DEBUG, "Dropped pc %x\n", p->pc);
 					delete p;
 					f_ready.write(0);
 				}
@@ -283,6 +363,7 @@ SC_MODULE(Top)
 		tb("tb"),
 		axi_signals("axi-signals"),
 		tlm_bridge("tlm-bridge"),
+		idle_signals("idle-signals"),
 		checker("checker", checker_config()),
 		p_ready("p_ready"),
 		p_jmp("p_jmp"),
@@ -294,7 +375,12 @@ SC_MODULE(Top)
 		f_iw("f_iw"),
 		f_pc("f_pc"),
 		f_flush("f_flush"),
-		rand_seed(rand_seed)
+		f_depth("f_depth"),
+		queued_insns(64),
+		rand_seed(rand_seed),
+		mem_latency(plusarg_u64("mem-latency", 0)),
+		cycles(0),
+		insns(0)
 	{
 		m_qk.set_global_quantum(quantum);
 
@@ -302,6 +388,9 @@ SC_MODULE(Top)
 		SC_THREAD(decoder);
 		SC_METHOD(gen_rst_n);
 		sensitive << rst;
+		SC_METHOD(count_cycles);
+		sensitive << clk.posedge_event();
+		dont_initialize();
 
 	        target_socket.register_b_transport(this, &Top::b_transport);
 
@@ -311,7 +400,18 @@ SC_MODULE(Top)
 		tlm_bridge.resetn(rst_n);
 		tlm_bridge.socket(target_socket);
 
-		axi_signals.connect(tlm_bridge);
+		if (mem_latency) {
+			SC_METHOD(pipe_mem);
+			sensitive << clk.posedge_event();
+			dont_initialize();
+			axi_signals.awready.write(0);
+			axi_signals.wready.write(0);
+			axi_signals.bvalid.write(0);
+			axi_signals.bresp.write(0);
+			idle_signals.connect(tlm_bridge);
+		} else {
+			axi_signals.connect(tlm_bridge);
+		}
 		axi_signals.connect(checker);
 		axi_signals.connect(tb);
 
@@ -329,6 +429,7 @@ SC_MODULE(Top)
 		tb.f_iw(f_iw);
 		tb.f_pc(f_pc);
 		tb.f_flush(f_flush);
+		tb.f_depth(f_depth);
 	}
 
 private:
@@ -1,8 +1,11 @@
 `include "include/axi.svh"
+`include "rvee/rvee-config.svh"
 `include "rvee/rvee-pcgen.svh"
 `include "rvee/rvee-fetch.svh"
 
-module rvee_fetch_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
+// FETCH_DEPTH can be overridden with -GFETCH_DEPTH=N, see make fetch-sweep.
+module rvee_fetch_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32,
+		       FETCH_DEPTH=`RVEE_CONFIG_FETCH_DEPTH) (
 	input	clk,
 	input	rst,
 
@@ -40,7 +43,8 @@ module rvee_fetch_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	f_ready,
 	output	[31:0] f_iw,
 	output	[XLEN - 1:0] f_pc,
-	output	f_flush);
+	output	f_flush,
+	output	[7:0] f_depth);
 
 	wire    [XLEN - 1:0] resetv;
 
@@ -49,7 +53,7 @@ module rvee_fetch_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	rvee_fetch_if fetch_if(.*);
 
 	rvee_pcgen pcgen(.*);
-	rvee_fetch fetch(.*);
+	rvee_fetch #(.DEPTH(FETCH_DEPTH)) fetch(.*);
 
 	// Connect the interface to the outside world.
 	assign	awvalid = axi_fetch_if.awvalid;
@@ -81,10 +85,15 @@ module rvee_fetch_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	assign	pcgen_if.jmp = p_jmp;
 	assign	pcgen_if.jmp_base = p_jmp_base;
 	assign	pcgen_if.jmp_offset = p_jmp_offset;
+	// No decode or exec, so no predicted jumps or predictor updates.
+	assign	pcgen_if.pjmp = 0;
+	assign	pcgen_if.bp_we = 0;
+	assign	pcgen_if.bp_inval = 0;
 
 	assign	f_valid = fetch_if.valid;
 	assign	f_iw = fetch_if.iw;
 	assign	f_pc = fetch_if.pc;
 	assign	f_flush = fetch_if.flush;
+	assign	f_depth = FETCH_DEPTH;
 	assign	fetch_if.ready = f_ready;
 endmodule
@@ -0,0 +1,156 @@
+/*
+ * Fast-forwarding the RVee core on rvee_iss.
+ *
+ * rvee_ff_iss runs the image on the ISS, straight on the SoC's memory
+ * regions, up to a trigger PC or insn count. The harness then starts
+ * the core at the ISS PC through resetv, and the RTL, built with
+ * RVEE_DPI_BACKDOOR, loads the ISS registers and CSRs while in reset
+ * (rvee_dpi_backdoor_rf/csr). From there on it's cycle accurate.
+ *
+ * The mock UART is shared with the RTL. The CLINT lives in the RTL,
+ * the ISS only sees an mtime that counts insns and its writes are
+ * dropped. No interrupts are taken while fast-forwarding. Caches,
+ * predictors and the performance counters start out cold.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_FF_H__
+#define __TB_RVEE_FF_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "svdpi.h"
+#include "rvee_iss.h"
+#include "rvee_elf.h"
+#include "rvee_soc.h"
+
+#define RVEE_FF_MTIME	0xbff8
+
+class rvee_ff_iss : public rvee_iss {
+public:
+	rvee_ff_iss(rvee_mock_uart *uart) : uart(uart) {
+#ifdef RVEE_CONFIG_M
+		ext_m = true;
+#endif
+#ifdef RVEE_CONFIG_C
+		ext_c = true;
+#endif
+	}
+
+	// Runs until the PC hits stop_pc or stop_insns insns have
+	// retired (0 for either means no such trigger), or until the
+	// program exits.
+	void run(uint64_t stop_pc, uint64_t stop_insns,
+		 const uint8_t *tohost) {
+		retire r;
+
+		while (!uart->exited) {
+			if (stop_pc && pc == stop_pc) {
+				break;
+			}
+			if (stop_insns && instret >= stop_insns) {
+				break;
+			}
+			step(&r);
+			if (tohost) {
+				rvee_soc_poll_tohost(tohost, uart);
+			}
+		}
+	}
+
+	bool mmio_read(uint64_t addr, unsigned int size, xlen_t *v) {
+		*v = 0;
+		if (addr - RVEE_SOC_UART_BASE < RVEE_SOC_UART_SIZE) {
+			uart->access(true, addr - RVEE_SOC_UART_BASE,
+				     (uint8_t *) v, size);
+		} else if (addr - RVEE_SOC_CLINT_BASE == RVEE_FF_MTIME) {
+			*v = instret;
+		} else if (addr - RVEE_SOC_CLINT_BASE == RVEE_FF_MTIME + 4) {
+			*v = instret >> 32;
+		}
+		return true;
+	}
+
+	void mmio_write(uint64_t addr, unsigned int size, xlen_t v) {
+		if (addr - RVEE_SOC_UART_BASE < RVEE_SOC_UART_SIZE) {
+			uart->access(false, addr - RVEE_SOC_UART_BASE,
+				     (uint8_t *) &v, size);
+		}
+	}
+
+private:
+	rvee_mock_uart *uart;
+};
+
+// The trigger PC is an address or a symbol of the image.
+static inline bool rvee_ff_parse_pc(const char *s, const rvee_elf *elf,
+				    uint64_t *pc)
+{
+	char *end;
+
+	*pc = strtoull(s, &end, 0);
+	if (*s && !*end) {
+		return true;
+	}
+	if (elf->sym(s, pc)) {
+		return true;
+	}
+	fprintf(stderr, "%s: no such address or symbol\n", s);
+	return false;
+}
+
+// State the RTL picks up while in reset, NULL for a plain reset.
+// One core per simulation, the DPI calls have no instance argument.
+static rvee_iss *rvee_ff_state;
+
+extern "C" svBit rvee_dpi_backdoor_rf(int r, int *v)
+{
+	if (!rvee_ff_state) {
+		return 0;
+	}
+	*v = rvee_ff_state->R[r];
+	return 1;
+}
+
+extern "C" svBit rvee_dpi_backdoor_csr(int csr, int *v)
+{
+	const rvee_iss *s = rvee_ff_state;
+
+	if (!s) {
+		return 0;
+	}
+	switch (csr) {
+	case RV_CSR_MSTATUS: *v = s->mstatus; break;
+	case RV_CSR_MIE: *v = s->mie; break;
+	case RV_CSR_MTVEC: *v = s->mtvec; break;
+	case RV_CSR_MSCRATCH: *v = s->mscratch; break;
+	case RV_CSR_MEPC: *v = s->mepc; break;
+	case RV_CSR_MCAUSE: *v = s->mcause; break;
+	case RV_CSR_MTVAL: *v = s->mtval; break;
+	default:
+		return 0;
+	}
+	return 1;
+}
+#endif
@@ -0,0 +1,619 @@
+/*
+ * RV32I[MC] + Zicsr instruction set simulator.
+ *
+ * A small golden model of the RVee core. Executes one instruction per
+ * step() and reports the register write and trap it caused so that it
+ * can be compared against the RTL (see rvee_lockstep.h).
+ *
+ * Misaligned loads and stores that stay within a 32-bit word are
+ * performed, ones that cross a word boundary trap, like on RVee.
+ * Accesses outside of the memory regions go to the mmio_read/mmio_write
+ * hooks. Stores to ROM regions are dropped, RVee ignores the bus error
+ * they get.
+ *
+ * Jumps and branches to targets that aren't aligned to an insn raise
+ * insn misaligned traps here. RVee has no such trap and fetches from the
+ * misaligned PC instead, so lockstep reports such a jump as a mismatch.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_ISS_H__
+#define __TB_RVEE_ISS_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "rvee.h"
+
+#define RV_CSR_MSTATUS		0x300
+#define RV_CSR_MISA		0x301
+#define RV_CSR_MIE		0x304
+#define RV_CSR_MTVEC		0x305
+#define RV_CSR_MSCRATCH		0x340
+#define RV_CSR_MEPC		0x341
+#define RV_CSR_MCAUSE		0x342
+#define RV_CSR_MTVAL		0x343
+#define RV_CSR_MIP		0x344
+#define RV_CSR_MCOUNTINHIBIT	0x320
+#define RV_CSR_MCYCLE		0xb00
+#define RV_CSR_MINSTRET		0xb02
+#define RV_CSR_MCYCLEH		0xb80
+#define RV_CSR_MINSTRETH	0xb82
+#define RV_CSR_CYCLE		0xc00
+#define RV_CSR_TIME		0xc01
+#define RV_CSR_INSTRET		0xc02
+#define RV_CSR_CYCLEH		0xc80
+#define RV_CSR_TIMEH		0xc81
+#define RV_CSR_INSTRETH		0xc82
+
+#define RV_MSTATUS_MIE		(1U << 3)
+#define RV_MSTATUS_MPIE		(1U << 7)
+#define RV_MSTATUS_MPP		(3U << 11)
+
+// RVee implements MSIE and MTIE, MEIE reads as zero.
+#define RV_MIE_MASK		((1U << 3) | (1U << 7))
+
+// mcountinhibit has bits [RVEE_HPM_LAST:0] (see rvee-csr.svh), bit 1
+// (time) is hardwired to zero.
+#define RV_HPM_LAST		12
+#define RV_MCOUNTINHIBIT_MASK	(((1U << (RV_HPM_LAST + 1)) - 1) & ~(1U << 1))
+
+#define RV_CAUSE_IRQ			(1U << (XLEN - 1))
+#define RV_CAUSE_INSN_MISALIGNED	0
+#define RV_CAUSE_INSN_ACCESS_FAULT	1
+#define RV_CAUSE_ILLEGAL_INSN		2
+#define RV_CAUSE_BREAKPOINT		3
+#define RV_CAUSE_LOAD_MISALIGNED	4
+#define RV_CAUSE_LOAD_ACCESS_FAULT	5
+#define RV_CAUSE_STORE_MISALIGNED	6
+#define RV_CAUSE_STORE_ACCESS_FAULT	7
+#define RV_CAUSE_ECALL_M		11
+
+class rvee_iss {
+public:
+	// What a step did.
+	struct retire {
+		xlen_t pc;
+		uint32_t iw;
+		bool rd_we;
+		unsigned int rd;
+		xlen_t rd_data;
+		// rd_data came from a device or a free running counter and
+		// can't be predicted.
+		bool nondet;
+		bool trap;
+		xlen_t cause;
+	};
+
+	xlen_t pc;
+	xlen_t R[32];
+
+	xlen_t mstatus;
+	xlen_t mie;
+	xlen_t mtvec;
+	xlen_t mscratch;
+	xlen_t mepc;
+	xlen_t mcause;
+	xlen_t mtval;
+	xlen_t mcountinhibit;
+	uint64_t instret;
+
+	// RAM and ROM regions.
+	struct mem_region {
+		uint8_t *buf;
+		uint64_t base;
+		uint64_t size;
+		bool rom;
+	};
+	std::vector<mem_region> mem;
+
+	// RV32M and RV32C, set to match cores built with RVEE_CONFIG_M
+	// and RVEE_CONFIG_C.
+	bool ext_m;
+	bool ext_c;
+
+	rvee_iss() :
+		ext_m(false), ext_c(false) {
+		reset(0);
+	}
+
+	void add_mem(uint8_t *buf, uint64_t base, uint64_t size, bool rom) {
+		mem_region m = { buf, base, size, rom };
+
+		mem.push_back(m);
+	}
+
+	virtual ~rvee_iss() {}
+
+	void reset(xlen_t resetv) {
+		pc = resetv;
+		memset(R, 0, sizeof R);
+		mstatus = RV_MSTATUS_MPP;
+		mie = 0;
+		mtvec = 0;
+		mscratch = 0;
+		mepc = 0;
+		mcause = 0;
+		mtval = 0;
+		mcountinhibit = 0;
+		instret = 0;
+	}
+
+	// Takes over the PC, registers and CSRs of another ISS, e.g
+	// one that fast-forwarded. Memory stays as is.
+	void set_state(const rvee_iss *o) {
+		pc = o->pc;
+		memcpy(R, o->R, sizeof R);
+		mstatus = o->mstatus;
+		mie = o->mie;
+		mtvec = o->mtvec;
+		mscratch = o->mscratch;
+		mepc = o->mepc;
+		mcause = o->mcause;
+		mtval = o->mtval;
+		mcountinhibit = o->mcountinhibit;
+		instret = o->instret;
+	}
+
+	// Device hooks. Return false if the value read is unknown.
+	virtual bool mmio_read(uint64_t addr, unsigned int size, xlen_t *v) {
+		*v = 0;
+		return false;
+	}
+
+	virtual void mmio_write(uint64_t addr, unsigned int size, xlen_t v) {
+	}
+
+	void take_trap(xlen_t cause, xlen_t tval, xlen_t epc) {
+		mepc = epc;
+		mcause = cause;
+		mtval = tval;
+		mstatus &= ~RV_MSTATUS_MPIE;
+		if (mstatus & RV_MSTATUS_MIE) {
+			mstatus |= RV_MSTATUS_MPIE;
+		}
+		mstatus &= ~RV_MSTATUS_MIE;
+		pc = mtvec & ~3;
+	}
+
+	// True if iw always traps (illegal, ecall, ebreak) regardless of
+	// machine state.
+	bool insn_traps(uint32_t iw) {
+		switch (iw & 0x7f) {
+		case LUI_TYPE:
+		case AUIPC_TYPE:
+		case JAL_TYPE:
+		case BCC_TYPE:
+		case S_TYPE:
+		case I_JALR_TYPE:
+		case I_LD_TYPE:
+		case I_ALU_TYPE:
+		case R_ALU_TYPE:
+		case FENCE_TYPE:
+			return false;
+		case SYSTEM_TYPE:
+			return iw == 0x00000073;
+		default:
+			return true;
+		}
+	}
+
+	// Compressed insns come back expanded, with *len set to 2.
+	uint32_t fetch(xlen_t addr, bool *fault, unsigned int *len = NULL) {
+		const mem_region *m;
+		unsigned int n = 4;
+		uint32_t iw = 0;
+
+		if (ext_c) {
+			m = find_mem(addr, 2);
+			*fault = !m;
+			if (m) {
+				memcpy(&iw, m->buf + (addr - m->base), 2);
+				if ((iw & 3) != 3) {
+					iw = rv_rvc_expand(iw);
+					n = 2;
+				}
+			}
+		}
+		if (n == 4) {
+			m = find_mem(addr, 4);
+			*fault = !m;
+			if (m) {
+				memcpy(&iw, m->buf + (addr - m->base), 4);
+			}
+		}
+		if (len) {
+			*len = n;
+		}
+		return iw;
+	}
+
+	xlen_t ialign_mask(void) {
+		return ext_c ? 1 : 3;
+	}
+
+	void step(retire *r) {
+		xlen_t next_pc;
+		uint32_t iw;
+		unsigned int len;
+		unsigned int rd, rs1, rs2, funct3;
+		xlen_t a, b, imm;
+		bool fault;
+
+		memset(r, 0, sizeof *r);
+		r->pc = pc;
+
+		if (pc & ialign_mask()) {
+			r->trap = true;
+			r->cause = RV_CAUSE_INSN_MISALIGNED;
+			take_trap(r->cause, pc, pc);
+			return;
+		}
+
+		iw = fetch(pc, &fault, &len);
+		next_pc = pc + len;
+		r->iw = iw;
+		if (fault) {
+			r->trap = true;
+			r->cause = RV_CAUSE_INSN_ACCESS_FAULT;
+			take_trap(r->cause, pc, pc);
+			return;
+		}
+
+		rd = (iw >> 7) & 31;
+		rs1 = (iw >> 15) & 31;
+		rs2 = (iw >> 20) & 31;
+		funct3 = (iw >> 12) & 7;
+		a = R[rs1];
+		b = R[rs2];
+
+		switch (iw & 0x7f) {
+		case LUI_TYPE:
+			wb(r, rd, iw & 0xfffff000);
+			break;
+		case AUIPC_TYPE:
+			wb(r, rd, pc + (iw & 0xfffff000));
+			break;
+		case JAL_TYPE:
+			imm = ((iw >> 31) & 1) << 20 |
+				((iw >> 12) & 0xff) << 12 |
+				((iw >> 20) & 1) << 11 |
+				((iw >> 21) & 0x3ff) << 1;
+			next_pc = pc + rv_sext(21, imm);
+			if (!jump_ok(r, next_pc)) {
+				return;
+			}
+			wb(r, rd, pc + len);
+			break;
+		case I_JALR_TYPE:
+			next_pc = (a + rv_sext(12, iw >> 20)) & ~1;
+			if (!jump_ok(r, next_pc)) {
+				return;
+			}
+			wb(r, rd, pc + len);
+			break;
+		case BCC_TYPE: {
+			bool taken;
+
+			switch (funct3) {
+			case CC_EQ: taken = a == b; break;
+			case CC_NE: taken = a != b; break;
+			case CC_LT: taken = (sxlen_t) a < (sxlen_t) b; break;
+			case CC_GE: taken = (sxlen_t) a >= (sxlen_t) b; break;
+			case CC_LTU: taken = a < b; break;
+			case CC_GEU: taken = a >= b; break;
+			default:
+				illegal(r, iw);
+				return;
+			}
+			if (taken) {
+				imm = ((iw >> 31) & 1) << 12 |
+					((iw >> 7) & 1) << 11 |
+					((iw >> 25) & 0x3f) << 5 |
+					((iw >> 8) & 0xf) << 1;
+				next_pc = pc + rv_sext(13, imm);
+				if (!jump_ok(r, next_pc)) {
+					return;
+				}
+			}
+			break;
+		}
+		case I_LD_TYPE: {
+			xlen_t addr = a + rv_sext(12, iw >> 20);
+			unsigned int size = 1 << (funct3 & 3);
+			xlen_t v;
+
+			if ((funct3 & 3) == 3 || funct3 == 6) {
+				illegal(r, iw);
+				return;
+			}
+			if ((addr & 3) + size > 4) {
+				mem_trap(r, RV_CAUSE_LOAD_MISALIGNED, addr);
+				return;
+			}
+			if (!load(addr, size, &v)) {
+				r->nondet = true;
+			}
+			if (size < 4 && !(funct3 & 4)) {
+				v = rv_sext(size * 8, v);
+			}
+			wb(r, rd, v);
+			break;
+		}
+		case S_TYPE: {
+			xlen_t addr = a + rv_sext(12, (iw >> 25) << 5 | ((iw >> 7) & 0x1f));
+			unsigned int size = 1 << (funct3 & 3);
+
+			if (funct3 > 2) {
+				illegal(r, iw);
+				return;
+			}
+			if ((addr & 3) + size > 4) {
+				mem_trap(r, RV_CAUSE_STORE_MISALIGNED, addr);
+				return;
+			}
+			store(addr, size, b);
+			break;
+		}
+		case I_ALU_TYPE:
+			imm = rv_sext(12, iw >> 20);
+			if (funct3 == ALU_SLL || funct3 == ALU_SRL) {
+				// Shifts use imm[4:0], imm[11:5] is 0 or 0x20
+				// for SRAI.
+				if (iw >> 25 == 0x20 && funct3 == ALU_SRL) {
+					funct3 |= 8;
+				} else if (iw >> 25) {
+					illegal(r, iw);
+					return;
+				}
+				imm &= XLEN_CLOG2_MASK;
+			}
+			wb(r, rd, alu(funct3, a, imm));
+			break;
+		case R_ALU_TYPE:
+			if (ext_m && (iw >> 25) == 1) {
+				wb(r, rd, rv_muldiv(funct3, a, b));
+				break;
+			}
+			// funct7 is 0, or 0x20 for SUB and SRA.
+			if (iw >> 25 == 0x20 &&
+			    (funct3 == ALU_ADD || funct3 == ALU_SRL)) {
+				funct3 |= 8;
+			} else if (iw >> 25) {
+				illegal(r, iw);
+				return;
+			}
+			wb(r, rd, alu(funct3, a, b));
+			break;
+		case FENCE_TYPE:
+			break;
+		case SYSTEM_TYPE:
+			if (funct3 == 0) {
+				switch (iw) {
+				case 0x00000073: // ECALL
+					// RVee only writes mtval on mem faults.
+					r->trap = true;
+					r->cause = RV_CAUSE_ECALL_M;
+					take_trap(r->cause, mtval, pc);
+					return;
+				case 0x00100073: // EBREAK
+					// RVee decodes it but doesn't trap.
+					break;
+				case 0x30200073: // MRET
+					// Only jumps on RVee, mstatus is left as is.
+					next_pc = mepc;
+					break;
+				case 0x10500073: // WFI
+					break;
+				default:
+					illegal(r, iw);
+					return;
+				}
+			} else if (funct3 == 4) {
+				illegal(r, iw);
+				return;
+			} else {
+				unsigned int csr = iw >> 20;
+				xlen_t src = funct3 & 4 ? rs1 : a;
+				xlen_t old;
+
+				if (!csr_read(csr, &old)) {
+					r->nondet = true;
+				}
+				// Like on RVee, rs1/uimm 0 doesn't write, not
+				// even for CSRRW.
+				switch (rs1 ? funct3 & 3 : 0) {
+				case 1:
+					csr_write(csr, src);
+					break;
+				case 2:
+					csr_write(csr, old | src);
+					break;
+				case 3:
+					csr_write(csr, old & ~src);
+					break;
+				}
+				wb(r, rd, old);
+			}
+			break;
+		default:
+			illegal(r, iw);
+			return;
+		}
+
+		pc = next_pc;
+		instret++;
+	}
+
+private:
+	void wb(retire *r, unsigned int rd, xlen_t v) {
+		r->rd_we = true;
+		r->rd = rd;
+		r->rd_data = rd ? v : 0;
+		if (rd) {
+			R[rd] = v;
+		}
+	}
+
+	void illegal(retire *r, uint32_t iw) {
+		r->trap = true;
+		r->cause = RV_CAUSE_ILLEGAL_INSN;
+		take_trap(r->cause, iw, pc);
+	}
+
+	void mem_trap(retire *r, xlen_t cause, xlen_t addr) {
+		r->trap = true;
+		r->cause = cause;
+		take_trap(cause, addr, pc);
+	}
+
+	// RVee doesn't trap on misaligned jumps (see the top of the file),
+	// this is where the two models part ways.
+	bool jump_ok(retire *r, xlen_t dest) {
+		if (dest & ialign_mask()) {
+			r->trap = true;
+			r->cause = RV_CAUSE_INSN_MISALIGNED;
+			take_trap(r->cause, dest, pc);
+			return false;
+		}
+		return true;
+	}
+
+	// op is an rv_alu_op_t, bit 3 selects SUB/SRA.
+	xlen_t alu(unsigned int op, xlen_t a, xlen_t b) {
+		switch (op) {
+		case ALU_ADD: return a + b;
+		case ALU_ADD | 8: return a - b;
+		case ALU_SLL: return a << (b & XLEN_CLOG2_MASK);
+		case ALU_SLT: return (sxlen_t) a < (sxlen_t) b;
+		case ALU_SLTU: return a < b;
+		case ALU_XOR: return a ^ b;
+		case ALU_SRL: return a >> (b & XLEN_CLOG2_MASK);
+		case ALU_SRL | 8: return (sxlen_t) a >> (b & XLEN_CLOG2_MASK);
+		case ALU_OR: return a | b;
+		case ALU_AND: return a & b;
+		default:
+			// step() only passes valid ops.
+			return 0;
+		}
+	}
+
+	const mem_region *find_mem(xlen_t addr, unsigned int size) const {
+		unsigned int i;
+
+		for (i = 0; i < mem.size(); i++) {
+			if (addr >= mem[i].base &&
+			    addr - mem[i].base + size <= mem[i].size) {
+				return &mem[i];
+			}
+		}
+		return NULL;
+	}
+
+	bool load(xlen_t addr, unsigned int size, xlen_t *v) {
+		const mem_region *m = find_mem(addr, size);
+		uint32_t d = 0;
+
+		if (!m) {
+			return mmio_read(addr, size, v);
+		}
+		memcpy(&d, m->buf + (addr - m->base), size);
+		*v = d;
+		return true;
+	}
+
+	// Stores to ROM are dropped, rvee_mem doesn't look at bresp.
+	void store(xlen_t addr, unsigned int size, xlen_t v) {
+		const mem_region *m = find_mem(addr, size);
+		uint32_t d = v;
+
+		if (!m) {
+			mmio_write(addr, size, v);
+			return;
+		}
+		if (m->rom) {
+			return;
+		}
+		memcpy(m->buf + (addr - m->base), &d, size);
+	}
+
+	// Counters and their event selectors (mhpmevent).
+	static bool csr_is_counter(unsigned int csr) {
+		return (csr >= 0xb00 && csr < 0xb20) ||
+			(csr >= 0xb80 && csr < 0xba0) ||
+			(csr >= 0xc00 && csr < 0xc20) ||
+			(csr >= 0xc80 && csr < 0xca0) ||
+			(csr > 0x320 && csr < 0x340);
+	}
+
+	// Unknown CSRs read as zero and ignore writes, like on RVee.
+	bool csr_read(unsigned int csr, xlen_t *v) {
+		*v = 0;
+		if (csr_is_counter(csr)) {
+			return false;
+		}
+		switch (csr) {
+		// RVee only implements MIE as readable/writable,
+		// MPIE is kept for trap entry.
+		case RV_CSR_MSTATUS: *v = mstatus & RV_MSTATUS_MIE; break;
+		case RV_CSR_MISA:
+			*v = (1U << (XLEN - 2)) | (1U << 8) |
+				(ext_m ? 1U << 12 : 0) | (ext_c ? 1U << 2 : 0);
+			break;
+		case RV_CSR_MIE: *v = mie; break;
+		case RV_CSR_MTVEC: *v = mtvec; break;
+		case RV_CSR_MSCRATCH: *v = mscratch; break;
+		case RV_CSR_MEPC: *v = mepc; break;
+		case RV_CSR_MCAUSE: *v = mcause; break;
+		case RV_CSR_MTVAL: *v = mtval; break;
+		case RV_CSR_MCOUNTINHIBIT: *v = mcountinhibit; break;
+		case RV_CSR_MIP:
+			return false;
+		default:
+			break;
+		}
+		return true;
+	}
+
+	void csr_write(unsigned int csr, xlen_t v) {
+		switch (csr) {
+		case RV_CSR_MSTATUS:
+			mstatus = (mstatus & ~RV_MSTATUS_MIE) |
+				(v & RV_MSTATUS_MIE);
+			break;
+		case RV_CSR_MIE: mie = v & RV_MIE_MASK; break;
+		case RV_CSR_MTVEC: mtvec = v & ~3; break;
+		case RV_CSR_MSCRATCH: mscratch = v; break;
+		case RV_CSR_MEPC: mepc = v & ~ialign_mask(); break;
+		case RV_CSR_MCAUSE: mcause = v; break;
+		case RV_CSR_MTVAL: mtval = v; break;
+		case RV_CSR_MCOUNTINHIBIT:
+			mcountinhibit = v & RV_MCOUNTINHIBIT_MASK;
+			break;
+		default:
+			break;
+		}
+	}
+};
+#endif
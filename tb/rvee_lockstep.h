@@ -0,0 +1,198 @@
+/*
+ * Lockstep checking of the RVee core against rvee_iss.
+ *
+ * The core reports every instruction that leaves the mem stage through
+ * the rvee_dpi_retire DPI call (built with +define+RVEE_DPI_RETIRE).
+ * For each record we step the ISS and compare the PC and the register
+ * write. The first mismatch is reported and flagged in failed, the
+ * harness then stops the simulation.
+ *
+ * The ISS works on a private copy of RAM. Loads from devices and reads
+ * of free running counters can't be predicted, we take the value the
+ * RTL got and carry on.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_LOCKSTEP_H__
+#define __TB_RVEE_LOCKSTEP_H__
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "svdpi.h"
+#include "rvee_iss.h"
+
+class rvee_lockstep {
+public:
+	rvee_iss iss;
+	bool failed;
+	uint64_t checked;
+
+	rvee_lockstep(xlen_t resetv) :
+		failed(false),
+		checked(0),
+		mem_trap_pending(false) {
+		iss.reset(resetv);
+#ifdef RVEE_CONFIG_M
+		iss.ext_m = true;
+#endif
+#ifdef RVEE_CONFIG_C
+		iss.ext_c = true;
+#endif
+	}
+
+	~rvee_lockstep() {
+		unsigned int i;
+
+		for (i = 0; i < iss.mem.size(); i++) {
+			munmap(iss.mem[i].buf, iss.mem[i].size);
+		}
+	}
+
+	// The ISS runs on its own copy of each memory region. Only pages
+	// with data get copied, the copy stays as sparse as the original.
+	void add_mem(const uint8_t *buf, uint64_t base, uint64_t size,
+		     bool rom) {
+		static const uint8_t zero[4096] = { 0 };
+		uint8_t *shadow;
+		uint64_t off, n;
+
+		shadow = (uint8_t *) mmap(NULL, size, PROT_READ | PROT_WRITE,
+					  MAP_PRIVATE | MAP_ANONYMOUS |
+					  MAP_NORESERVE, -1, 0);
+		if (shadow == MAP_FAILED) {
+			perror("lockstep");
+			exit(EXIT_FAILURE);
+		}
+		for (off = 0; off < size; off += n) {
+			n = size - off < sizeof zero ? size - off : sizeof zero;
+			if (memcmp(buf + off, zero, n)) {
+				memcpy(shadow + off, buf + off, n);
+			}
+		}
+		iss.add_mem(shadow, base, size, rom);
+	}
+
+	void retire(xlen_t pc, bool rd_we, unsigned int rd, xlen_t rd_data,
+		    bool mem_trap, bool trap_entry) {
+		rvee_iss::retire r;
+
+		if (failed) {
+			return;
+		}
+
+		if (trap_entry) {
+			// Mem stage exceptions were already taken by the ISS
+			// when the faulting insn retired.
+			if (mem_trap_pending) {
+				mem_trap_pending = false;
+				return;
+			}
+			if (pc != iss.pc) {
+				mismatch("trap entry PC", pc, NULL);
+				return;
+			}
+			if (iss.insn_traps(iss.fetch(pc, &r.trap))) {
+				iss.step(&r);
+				return;
+			}
+			// Asynchronous. RVee reports all interrupts as
+			// machine software interrupts and leaves mtval alone.
+			iss.take_trap(RV_CAUSE_IRQ | 3, iss.mtval, pc);
+			return;
+		}
+
+		if (pc != iss.pc) {
+			mismatch("PC", pc, NULL);
+			return;
+		}
+
+		iss.step(&r);
+		if (mem_trap || r.trap) {
+			if (mem_trap != r.trap) {
+				mismatch(mem_trap ? "RTL trapped" : "ISS trapped",
+					 pc, &r);
+				return;
+			}
+			mem_trap_pending = true;
+			checked++;
+			return;
+		}
+
+		rd_we = rd_we && rd;
+		if (r.rd_we && r.rd && r.nondet) {
+			iss.R[r.rd] = rd_data;
+			r.rd_data = rd_data;
+		}
+		if (rd_we != (r.rd_we && r.rd != 0) ||
+		    (rd_we && (rd != r.rd || rd_data != r.rd_data))) {
+			printf("RTL: x%u=%08" PRIx64 " we=%d\n",
+			       rd, (uint64_t) rd_data, rd_we);
+			mismatch("register write", pc, &r);
+			return;
+		}
+		checked++;
+	}
+
+private:
+	bool mem_trap_pending;
+
+	void mismatch(const char *what, xlen_t pc, rvee_iss::retire *r) {
+		unsigned int i;
+
+		printf("LOCKSTEP: %s mismatch after %" PRIu64 " insns\n",
+		       what, checked);
+		printf("RTL: pc=%08" PRIx64 "\n", (uint64_t) pc);
+		if (r) {
+			printf("ISS: pc=%08" PRIx64 " iw=%08x x%u=%08" PRIx64
+			       " we=%d trap=%d cause=%" PRIx64 "\n",
+			       (uint64_t) r->pc, r->iw, r->rd,
+			       (uint64_t) r->rd_data, r->rd_we && r->rd,
+			       r->trap, (uint64_t) r->cause);
+		} else {
+			printf("ISS: pc=%08" PRIx64 "\n", (uint64_t) iss.pc);
+		}
+		for (i = 0; i < 32; i++) {
+			printf("x%-2u=%08" PRIx64 "%c", i, (uint64_t) iss.R[i],
+			       i % 8 == 7 ? '\n' : ' ');
+		}
+		fflush(stdout);
+		failed = true;
+	}
+};
+
+// One core per simulation, the DPI call has no instance argument.
+static rvee_lockstep *rvee_lockstep_inst;
+
+extern "C" void rvee_dpi_retire(int pc, svBit rd_we, int rd, int rd_data,
+				svBit mem_trap, svBit trap_entry)
+{
+	if (!rvee_lockstep_inst) {
+		return;
+	}
+	rvee_lockstep_inst->retire((uint32_t) pc, rd_we, rd, (uint32_t) rd_data,
+				   mem_trap, trap_entry);
+}
+#endif
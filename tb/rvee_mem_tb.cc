@@ -40,6 +40,7 @@ using namespace sc_dt;
 using namespace std;
 
 #include "rvee.h"
+#include "utils.h"
 
 #include "trace/trace.h"
 #include "Vrvee_mem_tb.h"
@@ -52,6 +53,15 @@ using namespace std;
 #define RVEE_BPU 1
 #define BPU_TAG_MASK (0xffUL << ((sizeof (xlen_t) - 1) * 8))
 
+/*
+ * A few words that loads and stores alias in, so that the store
+ * buffer has something to forward. Loads from it are checked against
+ * the contents in program order while the AXI side only sees what
+ * was actually written.
+ */
+#define ALIAS_BASE 0x1000
+#define ALIAS_SIZE 16
+
 
 AXILitePCConfig checker_config()
 {
@@ -107,11 +117,17 @@ SC_MODULE(Top)
 		uint64_t mem_data;
 
 		bool do_mem;
+		bool alias;
 	};
 
-	sc_fifo<payload *> queue_mem;
+	/* Loads may pass buffered stores, so they're queued apart.  */
+	sc_fifo<payload *> queue_load;
+	sc_fifo<payload *> queue_store;
 	sc_fifo<payload *> queue_wb;
 
+	uint8_t alias_mem[ALIAS_SIZE];
+	uint8_t alias_axi[ALIAS_SIZE];
+
 	unsigned int rand_seed;
 
 	SC_HAS_PROCESS(Top);
@@ -162,11 +178,27 @@ SC_MODULE(Top)
 
 				p->mem_sext = rand_r(&rand_seed) & 1 & p->mem_load;
 
+				p->alias = (rand_r(&rand_seed) & 3) == 0;
+				if (p->alias) {
+					unsigned int off = p->result & (ALIAS_SIZE - 1);
+					unsigned int size_bytes = 1 << p->mem_size;
+
+					p->result = ALIAS_BASE + off;
+					if (p->mem_load) {
+						p->mem_data = 0;
+						memcpy(&p->mem_data, &alias_mem[off], size_bytes);
+					} else {
+						memcpy(&alias_mem[off], &p->mem_data, size_bytes);
+					}
+				} else if (p->result - ALIAS_BASE < ALIAS_SIZE) {
+					p->result += ALIAS_SIZE;
+				}
+
 				p->rd_we = 0;
 				p->rd_data = p->mem_data;
 			}
 
-			printf("EX: pc %lx result=%lx rd_we=%d rd=%d b=%lx mem-data=%lx load=%d store=%d size=%d sext=%d\n",
+			TB_LOG(TB_LOG_DEBUG, "EX: pc %lx result=%lx rd_we=%d rd=%d b=%lx mem-data=%lx load=%d store=%d size=%d sext=%d\n",
 				(uint64_t) p->pc, (uint64_t) p->result, p->rd_we, p->rd,
 				(uint64_t) p->b, (uint64_t) p->mem_data,
 				p->mem_load, p->mem_store, p->mem_size,
@@ -183,8 +215,12 @@ SC_MODULE(Top)
 
 			e_rd_we.write(p->rd_we);
 			e_valid.write(1);
-			if (p->do_mem) {
-				queue_mem.write(p);
+			if (p->do_mem && !p->alias) {
+				if (p->mem_load) {
+					queue_load.write(p);
+				} else {
+					queue_store.write(p);
+				}
 			}
 			if (p->rd_we || p->mem_load) {
 				queue_wb.write(p);
@@ -196,6 +232,9 @@ SC_MODULE(Top)
 			}
 			e_rd_we.write(0);
 			e_valid.write(0);
+			if (p->alias && p->mem_store) {
+				delete p;
+			}
 			wait_rand_cycles();
 		}
 	}
@@ -209,12 +248,17 @@ SC_MODULE(Top)
 		uint64_t v = 0;
 		payload *p;
 
-		p = queue_mem.read();
+		if (addr >= ALIAS_BASE && addr < ALIAS_BASE + ALIAS_SIZE) {
+			alias_transport(trans);
+			return;
+		}
+
+		p = trans.is_read() ? queue_load.read() : queue_store.read();
 
 		if (trans.is_read()) {
 			uint64_t rdata = p->mem_data << ((p->result & 3) * 8);
 
-			printf("MEM: rdata=%lx mem_data=%lx\n",
+			TB_LOG(TB_LOG_DEBUG, "MEM: rdata=%lx mem_data=%lx\n",
 				rdata, p->mem_data);
 			memcpy(data, &rdata, size);
 		} else {
@@ -234,7 +278,7 @@ SC_MODULE(Top)
 			v >>= ((p->result & 3) * 8);
 		}
 
-		printf("MEM: addr=%lx.%lx rd_we=%d rd=%d v=%lx.%lx load=%d store=%d size=%d.%d sext=%d\n",
+		TB_LOG(TB_LOG_DEBUG, "MEM: addr=%lx.%lx rd_we=%d rd=%d v=%lx.%lx load=%d store=%d size=%d.%d sext=%d\n",
 			addr, (uint64_t) p->result, p->rd_we, p->rd,
 			v, (uint64_t) p->b,
 			p->mem_load, p->mem_store, size, p->mem_size,
@@ -258,6 +302,26 @@ SC_MODULE(Top)
 		trans.set_response_status(tlm::TLM_OK_RESPONSE);
 	}
 
+	void alias_transport(tlm::tlm_generic_payload& trans) {
+		unsigned char *data = trans.get_data_ptr();
+		unsigned int off = (trans.get_address() - ALIAS_BASE) & ~3;
+		unsigned int size = trans.get_data_length();
+		unsigned char *be = trans.get_byte_enable_ptr();
+		unsigned int be_len = trans.get_byte_enable_length();
+		unsigned int pos;
+
+		sc_assert(off + size <= ALIAS_SIZE);
+		for (pos = 0; pos < size; pos++) {
+			if (trans.is_read()) {
+				data[pos] = alias_axi[off + pos];
+			} else if (!be_len || be[pos % be_len] == TLM_BYTE_ENABLED) {
+				alias_axi[off + pos] = data[pos];
+			}
+		}
+		wait_rand_cycles();
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
 	void wb(void) {
 		xlen_t rd_data;
 		bool rd_we;
@@ -267,7 +331,7 @@ SC_MODULE(Top)
 
 		wait(rst.negedge_event());
 		while (true) {
-			printf("WAIT FOR rd_we\n");
+			TB_LOG(TB_LOG_DEBUG, "WAIT FOR rd_we\n");
 			while (m_rd_we.read() == 0) {
 				wait(clk.posedge_event());
 			}
@@ -289,7 +353,7 @@ SC_MODULE(Top)
 					masked_data = rv_sext(size_bytes * 8, masked_data);
 				}
 			}
-			printf("WB: pc %lx rd_we=%d.%d rd=%d.%d rd_data=%lx.%lx.%lx sz%d md=%lx\n",
+			TB_LOG(TB_LOG_DEBUG, "WB: pc %lx rd_we=%d.%d rd=%d.%d rd_data=%lx.%lx.%lx sz%d md=%lx\n",
 				(uint64_t) p->pc, rd_we, p->rd_we, rd, p->rd,
 				(uint64_t) rd_data, (uint64_t) p->rd_data, masked_data,
 				p->mem_size, p->mem_data);
@@ -300,6 +364,7 @@ SC_MODULE(Top)
 				sc_assert(rd_data == masked_data);
 			}
 			delete p;
+			tb_transaction_done();
 			wait(clk.posedge_event());
 		}
 	}
@@ -340,6 +405,8 @@ SC_MODULE(Top)
 		m_rd_data("m_rd_data"),
 		rand_seed(rand_seed)
 	{
+		memset(alias_mem, 0, sizeof alias_mem);
+		memset(alias_axi, 0, sizeof alias_axi);
 		m_qk.set_global_quantum(quantum);
 
 		SC_THREAD(pull_reset);
@@ -0,0 +1,103 @@
+/*
+ * Access to the core's performance counters from the testbench.
+ *
+ * rvee_csr, built with RVEE_DPI_PERF, registers its scope at start-up
+ * and exports rvee_dpi_perf_read() for us to read the counters.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_PERF_H__
+#define __TB_RVEE_PERF_H__
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "svdpi.h"
+
+// Counter numbers, as in mhpmcounter<N>.
+enum {
+	RVEE_PERF_CYCLE = 0,
+	RVEE_PERF_INSTRET = 2,
+	RVEE_PERF_HAZARD = 3,
+	RVEE_PERF_FLUSH = 4,
+	RVEE_PERF_REDIRECT = 5,
+	RVEE_PERF_MEM_WAIT = 6,
+	RVEE_PERF_TRAP = 7,
+	RVEE_PERF_IC_HIT = 8,
+	RVEE_PERF_IC_MISS = 9,
+	RVEE_PERF_DC_HIT = 10,
+	RVEE_PERF_DC_MISS = 11,
+	RVEE_PERF_DC_EVICT = 12,
+	RVEE_PERF_NUM = 13,
+};
+
+extern "C" long long rvee_dpi_perf_read(int idx);
+
+static svScope rvee_perf_scope;
+
+extern "C" void rvee_dpi_perf_scope(void)
+{
+	rvee_perf_scope = svGetScope();
+}
+
+// Returns false if the model has no counters.
+static inline bool rvee_perf_read(uint64_t v[RVEE_PERF_NUM])
+{
+	int i;
+
+	if (!rvee_perf_scope) {
+		return false;
+	}
+
+	svSetScope(rvee_perf_scope);
+	for (i = 0; i < RVEE_PERF_NUM; i++) {
+		v[i] = rvee_dpi_perf_read(i);
+	}
+	return true;
+}
+
+static inline void rvee_perf_print(FILE *fp)
+{
+	static const char *names[RVEE_PERF_NUM] = {
+		"cycles", NULL, "insns", "hazard bubbles", "flushed insns",
+		"redirects", "mem wait cycles", "traps",
+		"icache hits", "icache misses",
+		"dcache hits", "dcache misses", "dcache evictions",
+	};
+	uint64_t v[RVEE_PERF_NUM];
+	int i;
+
+	if (!rvee_perf_read(v)) {
+		return;
+	}
+
+	for (i = 0; i < RVEE_PERF_NUM; i++) {
+		if (names[i]) {
+			fprintf(fp, "%-16s %" PRIu64 "\n", names[i], v[i]);
+		}
+	}
+	if (v[RVEE_PERF_INSTRET]) {
+		fprintf(fp, "%-16s %.3f\n", "CPI",
+			(double) v[RVEE_PERF_CYCLE] / v[RVEE_PERF_INSTRET]);
+	}
+}
+#endif
@@ -0,0 +1,374 @@
+/*
+ * RV32C aligner and expander TB.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "systemc.h"
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/simple_target_socket.h"
+#include "tlm_utils/tlm_quantumkeeper.h"
+
+using namespace sc_core;
+using namespace sc_dt;
+using namespace std;
+
+#include <algorithm>
+#include <vector>
+
+#include "rvee.h"
+#include "utils.h"
+#include "plusargs.h"
+
+#include "trace/trace.h"
+#include "Vrvee_rvc_tb.h"
+#include "verilated_vcd_sc.h"
+
+#include "test-modules/signals-axilite.h"
+#include "tlm-bridges/axilite2tlm-bridge.h"
+#include "checkers/pc-axilite.h"
+
+AXILitePCConfig checker_config()
+{
+        AXILitePCConfig cfg;
+        cfg.enable_all_checks();
+	cfg.check_axi_handshakes(true, 1000);
+        return cfg;
+}
+
+SC_MODULE(Top)
+{
+	tlm_utils::simple_target_socket<Top> target_socket;
+	sc_signal<bool> rst;
+	sc_signal<bool> rst_n;
+	sc_clock clk;
+
+	Vrvee_rvc_tb tb;
+
+	AXILiteSignals<AWIDTH, DWIDTH> axi_signals;
+	axilite2tlm_bridge<AWIDTH, DWIDTH> tlm_bridge;
+	AXILiteProtocolChecker<AWIDTH, DWIDTH > checker;
+
+	sc_signal<bool> p_jmp;
+	sc_signal<bool> p_jmp_out;
+	sc_signal<sc_bv<XLEN> > p_jmp_base;
+	sc_signal<sc_bv<XLEN> > p_jmp_offset;
+
+	sc_signal<bool> f_valid;
+	sc_signal<bool> f_ready;
+	sc_signal<sc_bv<32> > f_iw;
+	sc_signal<sc_bv<XLEN> > f_pc;
+	sc_signal<bool> f_rvc;
+
+	unsigned int rand_seed;
+
+	// The program, every 16-bit encoding once in random order with
+	// random 32-bit insns in between, so that those start in both
+	// halves of a word. img holds it by halfword from address 0,
+	// insn_pc the start of every insn.
+	std::vector<uint16_t> img;
+	std::vector<xlen_t> insn_pc;
+
+	// Index into insn_pc of the next insn DECODE expects.
+	size_t next;
+	// Mirrors DECODE's flush_ff.
+	bool flush_ff;
+
+	// Coverage over a lap through the program. +laps=N stops after
+	// N laps, each of which must have covered all 16-bit encodings.
+	std::vector<bool> covered;
+	unsigned int max_laps;
+	unsigned int laps;
+	unsigned int straddles;
+	unsigned int drops;
+	unsigned int jmps_hi;
+	unsigned int jmps_straddle;
+
+	SC_HAS_PROCESS(Top);
+
+	void wait_cycles(unsigned int n) {
+		while (n--) {
+			wait(clk.posedge_event());
+		}
+	}
+
+	void wait_rand_cycles(void) {
+		unsigned int rand_delay = (rand_r(&rand_seed) & 0xf) + 1;
+		TB_LOG(TB_LOG_DEBUG, "%s: delay=%d\n", __func__, rand_delay);
+		wait_cycles(rand_delay);
+	}
+
+	// Zeroes past the end, they're only ever fetched and dropped.
+	uint16_t half(xlen_t addr) {
+		addr >>= 1;
+		return addr < img.size() ? img[addr] : 0;
+	}
+
+	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		unsigned char *data = trans.get_data_ptr();
+		uint64_t addr = trans.get_address();
+		uint32_t w;
+
+		sc_assert(trans.is_read());
+		sc_assert((addr & 3) == 0);
+
+		wait_rand_cycles();
+
+		w = half(addr) | (uint32_t) half(addr + 2) << 16;
+		TB_LOG(TB_LOG_DEBUG, "AXI: addr=%" PRIx64 " w=%x\n", addr, w);
+
+		memcpy(data, &w, trans.get_data_length());
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+	}
+
+	void gen_program(void) {
+		std::vector<uint16_t> enc;
+		unsigned int i;
+		uint32_t c;
+
+		for (c = 0; c < 0x10000; c++) {
+			if ((c & 3) != 3) {
+				enc.push_back(c);
+			}
+		}
+		for (i = enc.size() - 1; i > 0; i--) {
+			std::swap(enc[i], enc[rand_r(&rand_seed) % (i + 1)]);
+		}
+
+		for (i = 0; i < enc.size(); i++) {
+			insn_pc.push_back(img.size() * 2);
+			img.push_back(enc[i]);
+
+			if (rand_r(&rand_seed) % 3 == 0) {
+				uint32_t iw = rand_r(&rand_seed) | 3;
+
+				insn_pc.push_back(img.size() * 2);
+				img.push_back(iw);
+				img.push_back(iw >> 16);
+			}
+		}
+		covered.resize(0x10000);
+	}
+
+	void lap_done(void) {
+		unsigned int n = 0;
+		uint32_t c;
+
+		for (c = 0; c < 0x10000; c++) {
+			if ((c & 3) != 3) {
+				sc_assert(covered[c]);
+				n++;
+			}
+			covered[c] = false;
+		}
+		laps++;
+		printf("lap %u: %u 16-bit encodings, %u straddling insns, "
+			"%u drops, %u jumps to upper halves (%u straddling)\n",
+			laps, n, straddles, drops, jmps_hi, jmps_straddle);
+		sc_assert(straddles && drops && jmps_hi && jmps_straddle);
+		straddles = drops = jmps_hi = jmps_straddle = 0;
+
+		if (max_laps && laps == max_laps) {
+			printf("PASS: seed=%u laps=%u\n", tb_rand_seed, laps);
+			sc_stop();
+		}
+	}
+
+	// Checks an insn that DECODE takes. Returns true to jump.
+	bool check(void) {
+		xlen_t pc = f_pc.read().to_uint();
+		uint32_t iw = f_iw.read().to_uint();
+		bool rvc = f_rvc.read();
+		xlen_t epc = insn_pc[next];
+		uint16_t hw = half(epc);
+
+		TB_LOG(TB_LOG_DEBUG, "DECODER: pc=%x.%x iw=%x hw=%x rvc=%d\n",
+			pc, epc, iw, hw, rvc);
+
+		sc_assert(pc == epc);
+		if ((hw & 3) != 3) {
+			sc_assert(rvc);
+			sc_assert(iw == rv_rvc_expand(hw));
+			covered[hw] = true;
+		} else {
+			sc_assert(!rvc);
+			sc_assert(iw == (hw | (uint32_t) half(epc + 2) << 16));
+			if (epc & 2) {
+				straddles++;
+			}
+		}
+		tb_transaction_done();
+
+		next++;
+		if (next == insn_pc.size()) {
+			lap_done();
+			next = 0;
+			return true;
+		}
+		// Back to one of the last 8 insns, never the fall-through
+		// so that anything stale shows up as a wrong pc.
+		if ((rand_r(&rand_seed) & 0xf) == 0) {
+			next -= std::min(next, (size_t) (rand_r(&rand_seed) % 8) + 1);
+			return true;
+		}
+		return false;
+	}
+
+	// Plays DECODE once per cycle on the values prior to the edge.
+	void decoder(void) {
+		bool valid = f_valid.read();
+		bool jmp = p_jmp.read();
+		bool flush_jmp = jmp || p_jmp_out.read();
+		bool flush = flush_jmp || flush_ff;
+		bool n_jmp = false;
+
+		if (rst.read()) {
+			next = 0;
+			flush_ff = false;
+			f_ready.write(0);
+			p_jmp.write(0);
+			return;
+		}
+
+		if (valid && f_ready.read()) {
+			if (flush) {
+				TB_LOG(TB_LOG_DEBUG, "DECODER: drop pc=%x\n",
+					f_pc.read().to_uint());
+				drops++;
+			} else {
+				n_jmp = check();
+			}
+		}
+		flush_ff = flush_jmp && !valid;
+
+		if (n_jmp) {
+			xlen_t dest = insn_pc[next];
+			xlen_t offset = rand_r(&rand_seed) & 0xfe;
+
+			TB_LOG(TB_LOG_DEBUG, "JMP to %x\n", dest);
+			if (dest & 2) {
+				jmps_hi++;
+				if ((half(dest) & 3) == 3) {
+					jmps_straddle++;
+				}
+			}
+			p_jmp_base.write(dest - offset);
+			p_jmp_offset.write(offset);
+		}
+		p_jmp.write(n_jmp);
+
+		// DECODE drops while flushing. EX has just jumped so it's
+		// idle and never stalls it. Otherwise random back-pressure.
+		f_ready.write(n_jmp || jmp || flush_ff ||
+			      (rand_r(&rand_seed) & 3) != 0);
+	}
+
+	void pull_reset(void) {
+		/* Pull the reset signal.  */
+		rst.write(true);
+		wait(clk.negedge_event());
+		wait(clk.posedge_event());
+		rst.write(false);
+	}
+
+	void gen_rst_n(void) {
+		rst_n.write(!rst.read());
+	}
+
+	Top(sc_module_name name, sc_time quantum, unsigned int rand_seed) :
+		target_socket("target-socket"),
+		rst("rst"),
+		rst_n("rst_n"),
+		clk("clk", sc_time(10, SC_NS)),
+		tb("tb"),
+		axi_signals("axi-signals"),
+		tlm_bridge("tlm-bridge"),
+		checker("checker", checker_config()),
+		p_jmp("p_jmp"),
+		p_jmp_out("p_jmp_out"),
+		p_jmp_base("p_jmp_base"),
+		p_jmp_offset("p_jmp_offset"),
+		f_valid("f_valid"),
+		f_ready("f_ready"),
+		f_iw("f_iw"),
+		f_pc("f_pc"),
+		f_rvc("f_rvc"),
+		rand_seed(rand_seed),
+		next(0),
+		flush_ff(false),
+		max_laps(plusarg_u64("laps", 0)),
+		laps(0),
+		straddles(0),
+		drops(0),
+		jmps_hi(0),
+		jmps_straddle(0)
+	{
+		m_qk.set_global_quantum(quantum);
+
+		gen_program();
+
+		SC_THREAD(pull_reset);
+		SC_METHOD(decoder);
+		sensitive << clk.posedge_event();
+		dont_initialize();
+		SC_METHOD(gen_rst_n);
+		sensitive << rst;
+
+	        target_socket.register_b_transport(this, &Top::b_transport);
+
+		checker.clk(clk);
+		checker.resetn(rst_n);
+		tlm_bridge.clk(clk);
+		tlm_bridge.resetn(rst_n);
+		tlm_bridge.socket(target_socket);
+
+		axi_signals.connect(tlm_bridge);
+		axi_signals.connect(checker);
+		axi_signals.connect(tb);
+
+		tb.rst(rst);
+		tb.clk(clk);
+
+		tb.p_jmp(p_jmp);
+		tb.p_jmp_out(p_jmp_out);
+		tb.p_jmp_base(p_jmp_base);
+		tb.p_jmp_offset(p_jmp_offset);
+
+		tb.f_valid(f_valid);
+		tb.f_ready(f_ready);
+		tb.f_iw(f_iw);
+		tb.f_pc(f_pc);
+		tb.f_rvc(f_rvc);
+	}
+
+private:
+	tlm_utils::tlm_quantumkeeper m_qk;
+};
+
+#include "sc_main.h"
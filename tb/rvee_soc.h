@@ -0,0 +1,373 @@
+/*
+ * RVee testbench SoC pieces shared between the SystemC and the
+ * plain C++ harnesses.
+ *
+ * The memory map is:
+ * 0x00000000 RAM (by default, see rvee_soc_memmap)
+ * 0xa0000000 CLINT (RTL)
+ * 0xff000000 Mock UART and exit device
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_SOC_H__
+#define __TB_RVEE_SOC_H__
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "axilite_fast.h"
+#include "rvee_elf.h"
+
+#define RVEE_SOC_CLINT_BASE	0xa0000000ULL
+#define RVEE_SOC_CLINT_SIZE	0x10000
+#define RVEE_SOC_UART_BASE	0xff000000ULL
+#define RVEE_SOC_UART_SIZE	0x200
+
+// A mock of the Xilinx UARTLite TX side plus a few simulation helpers.
+// Writes to EXIT record the exit code, it's up to the harness to stop.
+// Writes to CKPT ask the harness for a checkpoint.
+class rvee_mock_uart : public axilite_dev {
+public:
+	enum {
+		R_STATUS = 0x2c,
+		R_TX = 0x30,
+		R_HEX = 0x104,
+		R_EXIT = 0x108,
+		R_CKPT = 0x10c,
+	};
+
+	bool exited;
+	int exit_code;
+	// The firmware asked for a checkpoint (see rvee_ckpt.h).
+	bool ckpt_req;
+
+	rvee_mock_uart() : exited(false), exit_code(0), ckpt_req(false) {}
+
+	void access(bool is_read, uint64_t addr, uint8_t *ptr,
+		    unsigned int len) {
+		if (is_read) {
+			uint32_t v = 0;
+
+			switch (addr) {
+			case R_STATUS:
+				v |= 8;	// Tempty
+				break;
+			default:
+				break;
+			}
+			memset(ptr, 0, len);
+			memcpy(ptr, &v, len > sizeof v ? sizeof v : len);
+		} else {
+			uint64_t c = 0;
+
+			memcpy(&c, ptr, len > sizeof c ? sizeof c : len);
+
+			switch (addr) {
+			case R_TX:
+				printf("%c", (unsigned char) c & 0xff);
+				break;
+			case R_HEX:
+				printf("HEX: 0x%8.8lx\n", c);
+				break;
+			case R_EXIT:
+				do_exit(c);
+				break;
+			case R_CKPT:
+				ckpt_req = true;
+				break;
+			}
+		}
+	}
+
+	void do_exit(int code) {
+		printf("EXIT %d\n", code);
+		fflush(stdout);
+		exited = true;
+		exit_code = code;
+	}
+
+	bool read(uint64_t addr, uint32_t *data, uint8_t *resp) {
+		access(true, addr, (uint8_t *) data, 4);
+		*resp = AXILITE_RESP_OKAY;
+		return true;
+	}
+
+	bool write(uint64_t addr, uint32_t data, uint8_t strb, uint8_t *resp) {
+		access(false, addr, (uint8_t *) &data, 4);
+		*resp = AXILITE_RESP_OKAY;
+		return true;
+	}
+};
+
+// RAM and ROM regions, set up at run time from a spec like
+// "ram:0:1M,rom:0x20000000:64K,ram:0x40000000:256M". Bases and sizes
+// are page aligned, sizes take K, M and G suffixes.
+//
+// Each region is an anonymous mapping, so pages that are never touched
+// cost neither memory nor time however large the region, and ELF images
+// can map file pages over it. Memory that isn't loaded reads as zero.
+// ROM is read-only to the core, stores to it get a bus error. RVee
+// doesn't look at bresp, so on the core they are just dropped.
+#define RVEE_SOC_MEM_DEFAULT	"ram:0:1M"
+
+struct rvee_soc_region {
+	uint64_t base;
+	uint64_t size;
+	bool rom;
+	uint8_t *buf;
+	axilite_ram *dev;
+};
+
+class rvee_soc_memmap {
+public:
+	std::vector<rvee_soc_region> regions;
+
+	~rvee_soc_memmap() {
+		unsigned int i;
+
+		for (i = 0; i < regions.size(); i++) {
+			delete regions[i].dev;
+			munmap(regions[i].buf, regions[i].size);
+		}
+	}
+
+	bool parse(const char *spec) {
+		const char *p = spec;
+
+		while (*p) {
+			rvee_soc_region r;
+			char *end;
+
+			if (!strncmp(p, "ram:", 4)) {
+				r.rom = false;
+			} else if (!strncmp(p, "rom:", 4)) {
+				r.rom = true;
+			} else {
+				return parse_error(spec, p);
+			}
+			r.base = strtoull(p + 4, &end, 0);
+			if (*end != ':') {
+				return parse_error(spec, p);
+			}
+			r.size = parse_size(end + 1, &end);
+			if (*end && *end != ',') {
+				return parse_error(spec, p);
+			}
+			p = *end ? end + 1 : end;
+
+			if (!add(r.base, r.size, r.rom)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool add(uint64_t base, uint64_t size, bool rom) {
+		uint64_t pgsz = sysconf(_SC_PAGESIZE);
+		rvee_soc_region r = { base, size, rom, NULL, NULL };
+		unsigned int i;
+
+		if (size == 0 || base % pgsz || size % pgsz ||
+		    base + size > (1ULL << 32) ||
+		    overlaps(base, size, RVEE_SOC_CLINT_BASE,
+			     RVEE_SOC_CLINT_SIZE) ||
+		    overlaps(base, size, RVEE_SOC_UART_BASE,
+			     RVEE_SOC_UART_SIZE)) {
+			fprintf(stderr, "Bad memory region 0x%" PRIx64
+				" size 0x%" PRIx64 "\n", base, size);
+			return false;
+		}
+		for (i = 0; i < regions.size(); i++) {
+			if (overlaps(base, size, regions[i].base,
+				     regions[i].size)) {
+				fprintf(stderr, "Memory region 0x%" PRIx64
+					" overlaps 0x%" PRIx64 "\n",
+					base, regions[i].base);
+				return false;
+			}
+		}
+
+		r.buf = (uint8_t *) mmap(NULL, size, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS |
+					 MAP_NORESERVE, -1, 0);
+		if (r.buf == MAP_FAILED) {
+			perror("memory region");
+			return false;
+		}
+		r.dev = new axilite_ram(r.buf, size, rom);
+		regions.push_back(r);
+		return true;
+	}
+
+	// Back to all zeroes, dropping any pages mapped from an image.
+	void clear(rvee_soc_region *r) {
+		if (mmap(r->buf, r->size, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+			 -1, 0) == MAP_FAILED) {
+			perror("memory region");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// Host pointer for [addr, addr + len), NULL if unmapped.
+	uint8_t *ptr(uint64_t addr, uint64_t len) {
+		unsigned int i;
+
+		for (i = 0; i < regions.size(); i++) {
+			rvee_soc_region *r = &regions[i];
+
+			if (addr >= r->base && addr - r->base + len <= r->size) {
+				return r->buf + (addr - r->base);
+			}
+		}
+		return NULL;
+	}
+
+	// Put all regions on an AXI-Lite fast path bus.
+	void map(axilite_bus *bus) {
+		unsigned int i;
+
+		for (i = 0; i < regions.size(); i++) {
+			bus->memmap(regions[i].base, regions[i].size,
+				    regions[i].dev);
+		}
+	}
+
+	// Load an ELF image at its physical addresses (see rvee_elf.h)
+	// or a flat binary at the start of the first region.
+	// Returns the address to start at.
+	uint64_t load(const char *filename, rvee_elf *elf) {
+		rvee_soc_region *r = &regions[0];
+		unsigned int i;
+
+		if (!filename) {
+			return r->base;
+		}
+
+		if (rvee_elf::probe(filename)) {
+			if (!elf->open(filename)) {
+				exit(EXIT_FAILURE);
+			}
+			for (i = 0; i < regions.size(); i++) {
+				r = &regions[i];
+				if (!elf->load(r->buf, r->base, r->size, true)) {
+					exit(EXIT_FAILURE);
+				}
+			}
+			if (elf->loaded != elf->segments()) {
+				fprintf(stderr, "%s: segments outside of the "
+					"memory map\n", filename);
+				exit(EXIT_FAILURE);
+			}
+			printf("Loaded %s entry 0x%" PRIx64 " (%" PRIu64
+			       " pages mapped, %" PRIu64 " bytes copied)\n",
+			       filename, elf->entry, elf->mapped,
+			       elf->copied);
+			return elf->entry;
+		}
+
+		FILE *fp = fopen(filename, "rb");
+		size_t l = 0;
+
+		if (fp)
+			l = fread(r->buf, 1, r->size, fp);
+		if (!fp || ferror(fp)) {
+			perror(filename);
+			exit(EXIT_FAILURE);
+		}
+		fclose(fp);
+
+		printf("Loaded %s %zu bytes to 0x%" PRIx64 "\n",
+		       filename, l, r->base);
+		return r->base;
+	}
+
+	// Host pointer to the image's tohost word, NULL if it has none.
+	// Its address goes to *addr.
+	uint8_t *tohost(const rvee_elf *elf, uint64_t *addr) {
+		if (!elf->sym("tohost", addr)) {
+			return NULL;
+		}
+		return ptr(*addr, 4);
+	}
+
+private:
+	static bool overlaps(uint64_t a, uint64_t a_size,
+			     uint64_t b, uint64_t b_size) {
+		return a < b + b_size && b < a + a_size;
+	}
+
+	static uint64_t parse_size(const char *s, char **end) {
+		uint64_t v = strtoull(s, end, 0);
+
+		switch (**end) {
+		case 'G':
+			v <<= 10;
+			// Fall through.
+		case 'M':
+			v <<= 10;
+			// Fall through.
+		case 'K':
+			v <<= 10;
+			(*end)++;
+			break;
+		default:
+			break;
+		}
+		return v;
+	}
+
+	static bool parse_error(const char *spec, const char *p) {
+		fprintf(stderr, "Bad memory map \"%s\" at \"%s\"\n", spec, p);
+		return false;
+	}
+};
+
+// riscv-tests style exit, the firmware writes (code << 1) | 1 to
+// tohost. Polls RAM, for the fast-forward ISS which has no D-cache.
+static inline void rvee_soc_poll_tohost(const uint8_t *tohost,
+					rvee_mock_uart *uart)
+{
+	uint32_t v;
+
+	memcpy(&v, tohost, sizeof v);
+	if (v & 1) {
+		uart->do_exit(v >> 1);
+	}
+}
+
+// Same for the core, from a store on the commit port. With
+// RVEE_CONFIG_DCACHE the line may never be written back to RAM.
+static inline void rvee_soc_snoop_tohost(uint64_t tohost, uint64_t addr,
+					 uint32_t data, rvee_mock_uart *uart)
+{
+	if (addr == tohost && (data & 1)) {
+		uart->do_exit(data >> 1);
+	}
+}
+#endif
@@ -43,7 +43,6 @@ using namespace std;
 
 #include "trace/trace.h"
 #include "Vrvee_tb.h"
-#include "verilated_vcd_sc.h"
 
 #include "test-modules/signals-axilite.h"
 #include "tlm-bridges/axilite2tlm-bridge.h"
@@ -51,9 +50,16 @@ using namespace std;
 #include "checkers/pc-axilite.h"
 
 #include "soc/interconnect/iconnect.h"
-#include "tests/test-modules/memory.h"
 
-#define RAM_SIZE (1 * 1024 * 1024)
+#include "dmi_cache.h"
+#include "axilite_fast.h"
+#include "rvee_soc.h"
+#include "plusargs.h"
+#include "rvee_lockstep.h"
+#include "rvee_ff.h"
+#include "rvee_trace.h"
+#include "rvee_perf.h"
+#include "trace_ctl_sc.h"
 
 AXILitePCConfig checker_config()
 {
@@ -63,9 +69,126 @@ AXILitePCConfig checker_config()
         return cfg;
 }
 
+struct top_config {
+	// Serve RAM hits on the TLM path through DMI pointers.
+	bool dmi;
+	// Bypass TLM and serve the core ports with cycle-driven C++ models.
+	bool fast_axi;
+	// Attach AXI-Lite protocol checkers in fast_axi mode.
+	bool axi_check;
+	// Check every retired insn against rvee_iss.
+	bool lockstep;
+	// Write a binary commit trace (rvee_trace.h) to this file.
+	const char *commit_trace;
+	// Waveform tracing, retired PCs drive the trace_ctl triggers.
+	bool trace;
+	// Print the core's performance counters on exit.
+	bool perf;
+};
+
+// Serves the RAM and ROM regions of the memory map on the TLM path.
+// It takes the last interconnect port over the whole address space so
+// it sees absolute addresses, the devices are mapped before it.
+class soc_mem : public sc_core::sc_module
+{
+public:
+	tlm_utils::simple_target_socket<soc_mem> socket;
+
+	soc_mem(sc_core::sc_module_name name, rvee_soc_memmap *mem) :
+		sc_module(name),
+		socket("socket"),
+		mem(mem),
+		latency(1, SC_NS)
+	{
+		socket.register_b_transport(this, &soc_mem::b_transport);
+		socket.register_transport_dbg(this, &soc_mem::transport_dbg);
+		socket.register_get_direct_mem_ptr(this,
+				&soc_mem::get_direct_mem_ptr);
+	}
+
+private:
+	rvee_soc_memmap *mem;
+	sc_time latency;
+
+	rvee_soc_region *find(uint64_t addr) {
+		unsigned int i;
+
+		for (i = 0; i < mem->regions.size(); i++) {
+			rvee_soc_region *r = &mem->regions[i];
+
+			if (addr >= r->base && addr - r->base < r->size) {
+				return r;
+			}
+		}
+		return NULL;
+	}
+
+	unsigned int access(tlm::tlm_generic_payload& trans, bool debug) {
+		uint64_t addr = trans.get_address();
+		unsigned int len = trans.get_data_length();
+		unsigned char *data = trans.get_data_ptr();
+		unsigned char *be = trans.get_byte_enable_ptr();
+		unsigned int be_len = trans.get_byte_enable_length();
+		rvee_soc_region *r = find(addr);
+		unsigned char *host;
+		unsigned int i;
+
+		if (!r || addr - r->base + len > r->size) {
+			trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+			return 0;
+		}
+		if (trans.is_write() && r->rom && !debug) {
+			trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+			return 0;
+		}
+
+		host = r->buf + (addr - r->base);
+		for (i = 0; i < len; i++) {
+			if (be_len && be[i % be_len] != TLM_BYTE_ENABLED) {
+				continue;
+			}
+			if (trans.is_read()) {
+				data[i] = host[i];
+			} else {
+				host[i] = data[i];
+			}
+		}
+		trans.set_dmi_allowed(true);
+		trans.set_response_status(tlm::TLM_OK_RESPONSE);
+		return len;
+	}
+
+	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
+		access(trans, false);
+		delay += latency;
+	}
+
+	unsigned int transport_dbg(tlm::tlm_generic_payload& trans) {
+		return access(trans, true);
+	}
+
+	bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans,
+				tlm::tlm_dmi& dmi_data) {
+		rvee_soc_region *r = find(trans.get_address());
+
+		if (!r) {
+			return false;
+		}
+		dmi_data.set_dmi_ptr(r->buf);
+		dmi_data.set_start_address(r->base);
+		dmi_data.set_end_address(r->base + r->size - 1);
+		dmi_data.set_read_latency(latency);
+		dmi_data.set_write_latency(latency);
+		dmi_data.allow_read();
+		if (!r->rom) {
+			dmi_data.allow_read_write();
+		}
+		return true;
+	}
+};
+
 SC_MODULE(Top)
 {
-	tlm_utils::simple_target_socket<Top> target_socket;
 	sc_signal<bool> rst;
 	sc_signal<bool> rst_n;
 	sc_clock clk;
@@ -73,25 +196,121 @@ SC_MODULE(Top)
 	sc_signal<sc_bv<32> > resetv;
 	Vrvee_tb tb;
 
-	iconnect<2, 3> ic;
+	// Commit port.
+	sc_signal<bool> commit_valid;
+	sc_signal<sc_bv<32> > commit_pc;
+	sc_signal<sc_bv<32> > commit_iw;
+	sc_signal<bool> commit_rd_we;
+	sc_signal<sc_bv<5> > commit_rd;
+	sc_signal<sc_bv<32> > commit_wdata;
+	sc_signal<bool> commit_mem_load;
+	sc_signal<bool> commit_mem_store;
+	sc_signal<sc_bv<32> > commit_mem_addr;
+	sc_signal<bool> commit_trap;
+	sc_signal<bool> commit_trap_entry;
+	rvee_trace_writer *commit_trace;
+	trace_ctl *wave;
+	bool perf;
 
 	AXILiteSignals<AWIDTH, DWIDTH> fetch_signals;
-	axilite2tlm_bridge<AWIDTH, DWIDTH> fetch_bridge;
-	AXILiteProtocolChecker<AWIDTH, DWIDTH > fetch_checker;
-
 	AXILiteSignals<AWIDTH, DWIDTH> mem_signals;
-	axilite2tlm_bridge<AWIDTH, DWIDTH> mem_bridge;
-	AXILiteProtocolChecker<AWIDTH, DWIDTH > mem_checker;
-
 	AXILiteSignals<AWIDTH, DWIDTH> clint_signals;
-	tlm2axilite_bridge<AWIDTH, DWIDTH> clint_bridge;
-	AXILiteProtocolChecker<AWIDTH, DWIDTH > clint_checker;
 
-	uint8_t *rambuf;
-	memory ram;
+	AXILiteProtocolChecker<AWIDTH, DWIDTH > *fetch_checker;
+	AXILiteProtocolChecker<AWIDTH, DWIDTH > *mem_checker;
+	AXILiteProtocolChecker<AWIDTH, DWIDTH > *clint_checker;
+
+	// TLM path.
+	tlm_utils::simple_target_socket<Top> *target_socket;
+	iconnect<2, 3> *ic;
+
+	axilite2tlm_bridge<AWIDTH, DWIDTH> *fetch_bridge;
+	dmi_cache *fetch_dmi;
+
+	axilite2tlm_bridge<AWIDTH, DWIDTH> *mem_bridge;
+	dmi_cache *mem_dmi;
+
+	tlm2axilite_bridge<AWIDTH, DWIDTH> *clint_bridge;
+
+	rvee_soc_memmap *mem;
+	soc_mem *tlm_mem;
+
+	// Fast path.
+	axilite_pins fetch_pins;
+	axilite_pins mem_pins;
+	axilite_pins clint_pins;
+	axilite_initiator *fast_clint;
+	axilite_bus fetch_bus;
+	axilite_bus mem_bus;
+	axilite_target *fetch_port;
+	axilite_target *mem_port;
+
+	rvee_mock_uart uart;
+	rvee_elf elf;
+	uint64_t resetv_addr;
+	uint8_t *tohost;
+	uint64_t tohost_addr;
+
+	rvee_lockstep *lockstep;
 
 	SC_HAS_PROCESS(Top);
 
+	// Sampled on the rising edge, i.e the values from the cycle
+	// that just ended.
+	void commit_sample(void) {
+		rvee_commit c;
+
+		if (!commit_valid.read()) {
+			return;
+		}
+
+		c.pc = commit_pc.read().to_uint();
+		c.iw = commit_iw.read().to_uint();
+		c.rd_we = commit_rd_we.read();
+		c.rd = commit_rd.read().to_uint();
+		c.wdata = commit_wdata.read().to_uint();
+		c.mem_load = commit_mem_load.read();
+		c.mem_store = commit_mem_store.read();
+		c.mem_addr = commit_mem_addr.read().to_uint();
+		c.trap = commit_trap.read();
+		c.trap_entry = commit_trap_entry.read();
+		if (commit_trace) {
+			commit_trace->put(&c, sc_time_stamp() / clk.period());
+		}
+		if (wave) {
+			wave->pc(c.pc);
+		}
+	}
+
+	// The firmware exited.
+	void finish(int code) {
+		if (perf) {
+			rvee_perf_print(stdout);
+		}
+		tb_trace_finish(code != 0);
+		exit(code);
+	}
+
+	// Sampled like commit_sample.
+	void tohost_snoop(void) {
+		if (!commit_valid.read() || !commit_mem_store.read() ||
+		    commit_trap.read()) {
+			return;
+		}
+		rvee_soc_snoop_tohost(tohost_addr,
+				      commit_mem_addr.read().to_uint(),
+				      commit_wdata.read().to_uint(), &uart);
+		if (uart.exited) {
+			finish(uart.exit_code);
+		}
+	}
+
+	void lockstep_check(void) {
+		if (lockstep->failed) {
+			sc_stop();
+		}
+	}
+
 	void b_transport(tlm::tlm_generic_payload& trans, sc_time& delay) {
 		unsigned int len = trans.get_data_length();
 		uint64_t addr = trans.get_address();
@@ -101,42 +320,16 @@ SC_MODULE(Top)
 			trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
 		}
 
-		if (trans.is_read()) {
-			uint32_t v = 0;
-
-			switch (addr) {
-			case 0x2c:
-				v |= 8;	// Tempty
-				break;
-			default:
-				break;
-			}
-			memset(ptr, 0, len);
-			memcpy(ptr, &v, len > sizeof v ? sizeof v : len);
-		} else {
-			uint64_t c = 0;
-
-			memcpy(&c, ptr, len);
-
-			switch (addr) {
-			case 0x30:
-				printf("%c", (unsigned char) c & 0xff);
-				break;
-			case 0x104:
-				printf("HEX: 0x%8.8lx\n", c);
-				break;
-			case 0x108:
-				printf("EXIT %ld\n", c);
-				exit(c);
-				break;
-			}
+		uart.access(trans.is_read(), addr, ptr, len);
+		if (uart.exited) {
+			finish(uart.exit_code);
 		}
 	}
 
 	void pull_reset(void) {
 		/* Pull the reset signal.  */
 
-		resetv.write(0x0);
+		resetv.write(resetv_addr);
 		rst.write(true);
 		wait(clk.negedge_event());
 		wait(clk.posedge_event());
@@ -147,89 +340,214 @@ SC_MODULE(Top)
 		rst_n.write(!rst.read());
 	}
 
-	Top(sc_module_name name, sc_time quantum, const char *ramfile) :
-		target_socket("mock-uart-socket"),
+	// One process clocks all the fast-path ports.
+	void fast_axi_clock(void) {
+		axilite_pins_get_master(&fetch_pins, fetch_signals);
+		axilite_pins_get_master(&mem_pins, mem_signals);
+		axilite_pins_get_target(&clint_pins, clint_signals);
+
+		if (!rst_n.read()) {
+			fetch_port->reset(&fetch_pins);
+			mem_port->reset(&mem_pins);
+			fast_clint->reset(&clint_pins);
+		} else {
+			fetch_port->clock(&fetch_pins);
+			mem_port->clock(&mem_pins);
+			fast_clint->clock(&clint_pins);
+		}
+		if (uart.exited) {
+			finish(uart.exit_code);
+		}
+
+		axilite_pins_put_target(fetch_signals, &fetch_pins);
+		axilite_pins_put_target(mem_signals, &mem_pins);
+		axilite_pins_put_master(clint_signals, &clint_pins);
+	}
+
+	AXILiteProtocolChecker<AWIDTH, DWIDTH > *
+	new_checker(const char *name, AXILiteSignals<AWIDTH, DWIDTH> &signals) {
+		AXILiteProtocolChecker<AWIDTH, DWIDTH > *checker;
+
+		checker = new AXILiteProtocolChecker<AWIDTH, DWIDTH >(name,
+							checker_config());
+		checker->clk(clk);
+		checker->resetn(rst_n);
+		signals.connect(*checker);
+		return checker;
+	}
+
+	void setup_tlm(const top_config &cfg) {
+		target_socket = new tlm_utils::simple_target_socket<Top>("mock-uart-socket");
+		target_socket->register_b_transport(this, &Top::b_transport);
+
+		ic = new iconnect<2, 3>("ic");
+		tlm_mem = new soc_mem("mem", mem);
+
+		fetch_bridge = new axilite2tlm_bridge<AWIDTH, DWIDTH>("fetch-bridge");
+		fetch_dmi = new dmi_cache("fetch-dmi", cfg.dmi);
+		fetch_bridge->clk(clk);
+		fetch_bridge->resetn(rst_n);
+		fetch_bridge->socket(fetch_dmi->target_socket);
+		fetch_dmi->init_socket(*(ic->t_sk[0]));
+		fetch_signals.connect(*fetch_bridge);
+
+		mem_bridge = new axilite2tlm_bridge<AWIDTH, DWIDTH>("mem-bridge");
+		mem_dmi = new dmi_cache("mem-dmi", cfg.dmi);
+		mem_bridge->clk(clk);
+		mem_bridge->resetn(rst_n);
+		mem_bridge->socket(mem_dmi->target_socket);
+		mem_dmi->init_socket(*(ic->t_sk[1]));
+		mem_signals.connect(*mem_bridge);
+
+		clint_bridge = new tlm2axilite_bridge<AWIDTH, DWIDTH>("clint-bridge");
+		clint_bridge->clk(clk);
+		clint_bridge->resetn(rst_n);
+		clint_signals.connect(*clint_bridge);
+
+		ic->memmap(RVEE_SOC_UART_BASE, RVEE_SOC_UART_SIZE - 1, ADDRMODE_RELATIVE, -1, *target_socket);
+		ic->memmap(RVEE_SOC_CLINT_BASE, RVEE_SOC_CLINT_SIZE - 1, ADDRMODE_RELATIVE, -1,
+			  clint_bridge->tgt_socket);
+		ic->memmap(0, 0xffffffffULL, ADDRMODE_RELATIVE, -1, tlm_mem->socket);
+	}
+
+	void setup_fast(void) {
+		memset(&fetch_pins, 0, sizeof fetch_pins);
+		memset(&mem_pins, 0, sizeof mem_pins);
+		memset(&clint_pins, 0, sizeof clint_pins);
+
+		fast_clint = new axilite_initiator();
+
+		mem->map(&fetch_bus);
+
+		mem_bus.memmap(RVEE_SOC_UART_BASE, RVEE_SOC_UART_SIZE, &uart);
+		mem_bus.memmap(RVEE_SOC_CLINT_BASE, RVEE_SOC_CLINT_SIZE, fast_clint);
+		mem->map(&mem_bus);
+
+		fetch_port = new axilite_target(&fetch_bus);
+		mem_port = new axilite_target(&mem_bus);
+
+		SC_METHOD(fast_axi_clock);
+		sensitive << clk.posedge_event();
+		dont_initialize();
+	}
+
+	Top(sc_module_name name, sc_time quantum, const char *ramfile,
+	    rvee_soc_memmap *mem, const top_config &cfg) :
 		rst("rst"),
 		rst_n("rst_n"),
 		clk("clk", sc_time(10, SC_NS)),
 		resetv("resetv"),
 		tb("tb"),
-		ic("ic"),
+		commit_valid("commit_valid"),
+		commit_pc("commit_pc"),
+		commit_iw("commit_iw"),
+		commit_rd_we("commit_rd_we"),
+		commit_rd("commit_rd"),
+		commit_wdata("commit_wdata"),
+		commit_mem_load("commit_mem_load"),
+		commit_mem_store("commit_mem_store"),
+		commit_mem_addr("commit_mem_addr"),
+		commit_trap("commit_trap"),
+		commit_trap_entry("commit_trap_entry"),
+		commit_trace(NULL),
+		wave(NULL),
+		perf(cfg.perf),
 		fetch_signals("fetch-signals"),
-		fetch_bridge("fetch-bridge"),
-		fetch_checker("fetch-checker", checker_config()),
 		mem_signals("mem-signals"),
-		mem_bridge("mem-bridge"),
-		mem_checker("mem-checker", checker_config()),
 		clint_signals("clint-signals"),
-		clint_bridge("clint-bridge"),
-		clint_checker("clint-checker", checker_config()),
-		rambuf(new uint8_t [RAM_SIZE]),
-		ram("ram", sc_time(1, SC_NS), RAM_SIZE, rambuf)
+		fetch_checker(NULL),
+		mem_checker(NULL),
+		clint_checker(NULL),
+		target_socket(NULL),
+		ic(NULL),
+		fetch_bridge(NULL),
+		fetch_dmi(NULL),
+		mem_bridge(NULL),
+		mem_dmi(NULL),
+		clint_bridge(NULL),
+		mem(mem),
+		tlm_mem(NULL),
+		fast_clint(NULL),
+		fetch_port(NULL),
+		mem_port(NULL),
+		lockstep(NULL)
 	{
+		unsigned int i;
+
 		m_qk.set_global_quantum(quantum);
 
 		SC_THREAD(pull_reset);
 		SC_METHOD(gen_rst_n);
 		sensitive << rst;
 
-		target_socket.register_b_transport(this, &Top::b_transport);
-
 		tb.aresetn(rst_n);
 		tb.aclk(clk);
 		tb.resetv(resetv);
 
-		fetch_checker.clk(clk);
-		fetch_checker.resetn(rst_n);
-
-		fetch_bridge.clk(clk);
-		fetch_bridge.resetn(rst_n);
-		fetch_bridge.socket(*(ic.t_sk[0]));
+		tb.commit_valid(commit_valid);
+		tb.commit_pc(commit_pc);
+		tb.commit_iw(commit_iw);
+		tb.commit_rd_we(commit_rd_we);
+		tb.commit_rd(commit_rd);
+		tb.commit_wdata(commit_wdata);
+		tb.commit_mem_load(commit_mem_load);
+		tb.commit_mem_store(commit_mem_store);
+		tb.commit_mem_addr(commit_mem_addr);
+		tb.commit_trap(commit_trap);
+		tb.commit_trap_entry(commit_trap_entry);
 
-		fetch_signals.connect(fetch_bridge);
-		fetch_signals.connect(fetch_checker);
 		fetch_signals.connect(tb, "m00_");
-
-		mem_checker.clk(clk);
-		mem_checker.resetn(rst_n);
-
-		mem_bridge.clk(clk);
-		mem_bridge.resetn(rst_n);
-		mem_bridge.socket(*(ic.t_sk[1]));
-
-		mem_signals.connect(mem_bridge);
-		mem_signals.connect(mem_checker);
 		mem_signals.connect(tb, "m01_");
+		clint_signals.connect(tb, "s00_");
 
-		clint_checker.clk(clk);
-		clint_checker.resetn(rst_n);
+		if (cfg.fast_axi) {
+			setup_fast();
+		} else {
+			setup_tlm(cfg);
+		}
 
-		clint_bridge.clk(clk);
-		clint_bridge.resetn(rst_n);
+		// The TLM bridges always run with checkers, the fast path
+		// only on request.
+		if (!cfg.fast_axi || cfg.axi_check) {
+			fetch_checker = new_checker("fetch-checker", fetch_signals);
+			mem_checker = new_checker("mem-checker", mem_signals);
+			clint_checker = new_checker("clint-checker", clint_signals);
+		}
 
-		clint_signals.connect(clint_bridge);
-		clint_signals.connect(clint_checker);
-		clint_signals.connect(tb, "s00_");
+		resetv_addr = mem->load(ramfile, &elf);
+		tohost = mem->tohost(&elf, &tohost_addr);
+		if (tohost) {
+			SC_METHOD(tohost_snoop);
+			sensitive << clk.posedge_event();
+			dont_initialize();
+		}
 
-		ic.memmap(0xff000000ULL, 0x200 - 1, ADDRMODE_RELATIVE, -1, target_socket);
-		ic.memmap(0xa0000000ULL, 0x10000 - 1, ADDRMODE_RELATIVE, -1,
-			  clint_bridge.tgt_socket);
-		ic.memmap(0x00000000ULL, RAM_SIZE - 1, ADDRMODE_RELATIVE, -1, ram.socket);
+		if (cfg.commit_trace) {
+			commit_trace = new rvee_trace_writer();
+			if (!commit_trace->open(cfg.commit_trace)) {
+				exit(EXIT_FAILURE);
+			}
+		}
 
-		memset(rambuf, 0xff, RAM_SIZE);
-		if (ramfile) {
-			FILE *fp = fopen(ramfile, "rb");
-			size_t l = 0;
+		if (cfg.commit_trace || cfg.trace) {
+			SC_METHOD(commit_sample);
+			sensitive << clk.posedge_event();
+			dont_initialize();
+		}
 
-			if (fp)
-				l = fread(rambuf, 1, RAM_SIZE, fp);
-			if (!fp || ferror(fp)) {
-				perror(ramfile);
-				exit(EXIT_FAILURE);
+		if (cfg.lockstep) {
+			lockstep = new rvee_lockstep(resetv_addr);
+			for (i = 0; i < mem->regions.size(); i++) {
+				lockstep->add_mem(mem->regions[i].buf,
+						  mem->regions[i].base,
+						  mem->regions[i].size,
+						  mem->regions[i].rom);
 			}
-			fclose(fp);
+			rvee_lockstep_inst = lockstep;
 
-			printf("Loaded %s %zu bytes to RAM\n", ramfile, l);
+			SC_METHOD(lockstep_check);
+			sensitive << clk.negedge_event();
+			dont_initialize();
 		}
 	}
 
@@ -237,46 +555,79 @@ private:
 	tlm_utils::tlm_quantumkeeper m_qk;
 };
 
-#include "verilated_vcd_sc.h"
-
 int sc_main(int argc, char* argv[])
 {
 	sc_trace_file *trace_fp = NULL;
 	const char *ramfile = NULL;
+	top_config cfg;
+	rvee_soc_memmap mem;
+	uint64_t max_cycles;
+	int ret = 0;
 
 	Verilated::commandArgs(argc, argv);
 	sc_set_time_resolution(1, SC_PS);
 
-	if (argc >= 2) {
+	if (argc >= 2 && argv[1][0] != '+') {
 		ramfile = argv[1];
 	}
 
-	Top top("top", sc_time((double) 100, SC_NS), ramfile);
-#if VM_TRACE
-	Verilated::traceEverOn(true);
-	// If verilator was invoked with --trace argument,
-	// and if at run time passed the +trace argument, turn on tracing
-	VerilatedVcdSc *tfp = NULL;
-	const char* flag = Verilated::commandArgsPlusMatch("trace");
-	if (flag && !strcmp(flag, "+trace")) {
-		char fname[256];
-		tfp = new VerilatedVcdSc;
-		top.tb.trace(tfp, 100);
-
-		snprintf(fname, sizeof fname, "%s-verilator.vcd", argv[0]);
-		tfp->open(fname);
+	// +dmi lets the fetch and mem ports bypass the interconnect
+	// and access RAM directly through host pointers.
+	//
+	// +fast-axi replaces the TLM bridges, interconnect and checkers with
+	// cycle-driven C++ models bound directly to the core's pins.
+	// +axi-check brings back the protocol checkers in that mode.
+	//
+	// +lockstep runs rvee_iss alongside the core and stops at the
+	// first retired insn where they disagree.
+	cfg.dmi = plusarg_flag("dmi");
+	cfg.fast_axi = plusarg_flag("fast-axi");
+	cfg.axi_check = plusarg_flag("axi-check");
+	cfg.lockstep = plusarg_flag("lockstep");
+	cfg.commit_trace = plusarg_str("commit-trace", NULL);
+	cfg.trace = plusarg_flag("trace");
+	cfg.perf = plusarg_flag("perf");
+
+	// +max-cycles=N gives up after N cycles (0 means run forever).
+	max_cycles = plusarg_u64("max-cycles", 0);
+
+	// +mem=<spec> sets up the RAM and ROM regions (see rvee_soc.h).
+	if (!mem.parse(plusarg_str("mem", RVEE_SOC_MEM_DEFAULT))) {
+		return EXIT_FAILURE;
+	}
 
+	Top top("top", sc_time((double) 100, SC_NS), ramfile, &mem, cfg);
+#if VM_TRACE
+	// If verilator was invoked with --trace or --trace-fst and +trace
+	// was given at run time, trace the model (see trace_ctl.h).
+	// +trace-sc adds a VCD of the SystemC signals for the whole run.
+	top.wave = trace_ctl_setup(argv[0], top.tb, top.clk);
+	if (plusarg_flag("trace-sc")) {
 		trace_fp = sc_create_vcd_trace_file(argv[0]);
 		trace(trace_fp, top, top.name());
 	}
 #endif
-	sc_start();
+	if (max_cycles) {
+		sc_start(top.clk.period() * (double) max_cycles);
+	} else {
+		sc_start();
+	}
+	if (cfg.perf) {
+		rvee_perf_print(stdout);
+	}
+	if (top.lockstep && top.lockstep->failed) {
+		ret = EXIT_FAILURE;
+	} else if (max_cycles) {
+		printf("Timeout after %lu cycles\n", max_cycles);
+		ret = EXIT_FAILURE;
+	}
 	if (trace_fp) {
 		sc_close_vcd_trace_file(trace_fp);
 	}
+	delete top.commit_trace;
 
-#if VM_TRACE
-	delete tfp;
-#endif
-	return 0;
+	tb_trace_finish(ret != 0);
+	tb_trace_ctl = NULL;
+	delete top.wave;
+	return ret;
 }
@@ -5,11 +5,15 @@
 `include "rvee/rvee-exec.svh"
 `include "rvee/rvee-mem.svh"
 `include "rvee/rvee-rf.svh"
+`include "rvee/rvee-commit.svh"
 
 module rvee_tb #(parameter AWIDTH=32, DWIDTH=32, XLEN=32) (
 	input	aclk,
 	input	aresetn,
 	input	[XLEN - 1:0] resetv,
+`ifdef RVEE_CONFIG_COMMIT_PORT
+	`RVEE_COMMIT_PORT(XLEN),
+`endif
 	`AXILITE_MASTER_PORT("FETCH", m00_, AWIDTH, DWIDTH),
 	`AXILITE_MASTER_PORT("MEM", m01_, AWIDTH, DWIDTH),
 	`AXILITE_TARGET_PORT("CLINT", s00_, AWIDTH, DWIDTH)
@@ -0,0 +1,475 @@
+/*
+ * RVee plain C++ testbench.
+ *
+ * Same SoC as rvee_tb but without SystemC. The Verilated model is
+ * clocked from a C++ loop and RAM, the mock UART and the CLINT port
+ * are served by the cycle-driven models in axilite_fast.h.
+ *
+ * This is what we use for long firmware runs.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "verilated.h"
+#include "Vrvee_tb_fast.h"
+#if VM_TRACE
+#if VM_TRACE_FST
+#include "verilated_fst_c.h"
+typedef VerilatedFstC tb_trace_c_t;
+#else
+#include "verilated_vcd_c.h"
+typedef VerilatedVcdC tb_trace_c_t;
+#endif
+#endif
+
+#include "axilite_fast.h"
+#include "rvee_soc.h"
+#include "plusargs.h"
+#include "rvee_lockstep.h"
+#include "rvee_ff.h"
+#include "rvee_trace.h"
+#include "rvee_perf.h"
+#include "trace_ctl.h"
+#ifdef RVEE_TB_SAVABLE
+#include "rvee_ckpt.h"
+#endif
+
+// Move pins between the Verilated model and axilite_pins.
+#define AXILITE_PINS_GET_MASTER(p, m, prefix)		\
+	do {						\
+		(p)->arvalid = (m)->prefix##arvalid;	\
+		(p)->araddr = (m)->prefix##araddr;	\
+		(p)->awvalid = (m)->prefix##awvalid;	\
+		(p)->awaddr = (m)->prefix##awaddr;	\
+		(p)->wvalid = (m)->prefix##wvalid;	\
+		(p)->wdata = (m)->prefix##wdata;	\
+		(p)->wstrb = (m)->prefix##wstrb;	\
+		(p)->rready = (m)->prefix##rready;	\
+		(p)->bready = (m)->prefix##bready;	\
+	} while (0)
+
+#define AXILITE_PINS_PUT_TARGET(m, p, prefix)		\
+	do {						\
+		(m)->prefix##arready = (p)->arready;	\
+		(m)->prefix##rvalid = (p)->rvalid;	\
+		(m)->prefix##rdata = (p)->rdata;	\
+		(m)->prefix##rresp = (p)->rresp;	\
+		(m)->prefix##awready = (p)->awready;	\
+		(m)->prefix##wready = (p)->wready;	\
+		(m)->prefix##bvalid = (p)->bvalid;	\
+		(m)->prefix##bresp = (p)->bresp;	\
+	} while (0)
+
+#define AXILITE_PINS_GET_TARGET(p, m, prefix)		\
+	do {						\
+		(p)->arready = (m)->prefix##arready;	\
+		(p)->rvalid = (m)->prefix##rvalid;	\
+		(p)->rdata = (m)->prefix##rdata;	\
+		(p)->rresp = (m)->prefix##rresp;	\
+		(p)->awready = (m)->prefix##awready;	\
+		(p)->wready = (m)->prefix##wready;	\
+		(p)->bvalid = (m)->prefix##bvalid;	\
+		(p)->bresp = (m)->prefix##bresp;	\
+	} while (0)
+
+#define AXILITE_PINS_PUT_MASTER(m, p, prefix)		\
+	do {						\
+		(m)->prefix##arvalid = (p)->arvalid;	\
+		(m)->prefix##araddr = (p)->araddr;	\
+		(m)->prefix##arprot = 0;		\
+		(m)->prefix##awvalid = (p)->awvalid;	\
+		(m)->prefix##awaddr = (p)->awaddr;	\
+		(m)->prefix##awprot = 0;		\
+		(m)->prefix##wvalid = (p)->wvalid;	\
+		(m)->prefix##wdata = (p)->wdata;	\
+		(m)->prefix##wstrb = (p)->wstrb;	\
+		(m)->prefix##rready = (p)->rready;	\
+		(m)->prefix##bready = (p)->bready;	\
+	} while (0)
+
+#define RESET_CYCLES 2
+
+// Verilator needs this for $time in non SystemC builds.
+static uint64_t main_time;
+
+double sc_time_stamp(void)
+{
+	return main_time;
+}
+
+#ifdef RVEE_TB_SAVABLE
+// Harness state that goes into a checkpoint along with the model, in
+// the same order for rvee_ckpt_save and rvee_ckpt_restore.
+template<typename A>
+static void tb_ckpt(A &a, Vrvee_tb_fast *tb, uint64_t *cycles,
+		    axilite_pins *fetch_pins, axilite_pins *mem_pins,
+		    axilite_pins *clint_pins, axilite_target *fetch_port,
+		    axilite_target *mem_port, axilite_initiator *clint,
+		    rvee_soc_memmap *mem)
+{
+	a.io(&main_time, sizeof main_time);
+	a.io(cycles, sizeof *cycles);
+	a.model(tb);
+	a.io(fetch_pins, sizeof *fetch_pins);
+	a.io(mem_pins, sizeof *mem_pins);
+	a.io(clint_pins, sizeof *clint_pins);
+	fetch_port->ckpt(a);
+	mem_port->ckpt(a);
+	clint->ckpt(a);
+}
+#endif
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+	const char *ramfile = NULL;
+	rvee_soc_memmap mem;
+	rvee_elf elf;
+	uint8_t *tohost;
+	uint64_t tohost_addr;
+	uint64_t resetv;
+	unsigned int i;
+	uint64_t max_cycles;
+	uint64_t cycles = 0;
+	const char *ff_pc_arg;
+	uint64_t ff_pc = 0;
+	uint64_t ff_insns;
+	rvee_ff_iss *ff = NULL;
+	double ff_t = 0;
+	rvee_lockstep *lockstep = NULL;
+	rvee_trace_writer *commit_trace = NULL;
+	trace_ctl *wave = NULL;
+	const char *commit_trace_file;
+	const char *save_file;
+	const char *restore_file;
+#ifdef RVEE_TB_SAVABLE
+	uint64_t save_cycle;
+#endif
+	bool stats;
+	bool perf;
+	double t0, t;
+	int ret;
+
+	Verilated::commandArgs(argc, argv);
+
+	if (argc >= 2 && argv[1][0] != '+') {
+		ramfile = argv[1];
+	}
+
+	// +max-cycles=N gives up after N cycles (0 means run forever).
+	// +stats prints simulation speed on exit.
+	// +lockstep checks every retired insn against rvee_iss.
+	// +commit-trace=file writes a binary trace of retired insns.
+	// +perf prints the core's performance counters on exit.
+	// +mem=<spec> sets up the RAM and ROM regions (see rvee_soc.h).
+	// +save=file writes a checkpoint at cycle +save-cycle=N and
+	// whenever the firmware writes the CKPT register.
+	// +restore=file resumes from a checkpoint.
+	// +ff-pc=addr|symbol and +ff-insns=N run the ISS up to there and
+	// start the core from its state (see rvee_ff.h).
+	max_cycles = plusarg_u64("max-cycles", 0);
+	stats = plusarg_flag("stats");
+	perf = plusarg_flag("perf");
+	commit_trace_file = plusarg_str("commit-trace", NULL);
+	save_file = plusarg_str("save", NULL);
+	restore_file = plusarg_str("restore", NULL);
+	ff_pc_arg = plusarg_str("ff-pc", NULL);
+	ff_insns = plusarg_u64("ff-insns", 0);
+#ifdef RVEE_TB_SAVABLE
+	save_cycle = plusarg_u64("save-cycle", 0);
+#else
+	if (save_file || restore_file) {
+		fprintf(stderr, "Built without checkpoint support\n");
+		return EXIT_FAILURE;
+	}
+#endif
+	// The ISS would need a checkpoint of its own.
+	if (restore_file && plusarg_flag("lockstep")) {
+		fprintf(stderr, "+lockstep does not work with +restore\n");
+		return EXIT_FAILURE;
+	}
+	if (restore_file && (ff_pc_arg || ff_insns)) {
+		fprintf(stderr, "+restore does not work with +ff-*\n");
+		return EXIT_FAILURE;
+	}
+	if (!mem.parse(plusarg_str("mem", RVEE_SOC_MEM_DEFAULT))) {
+		return EXIT_FAILURE;
+	}
+
+	Vrvee_tb_fast *tb = new Vrvee_tb_fast("tb");
+
+	axilite_pins fetch_pins;
+	axilite_pins mem_pins;
+	axilite_pins clint_pins;
+	rvee_mock_uart uart;
+	axilite_initiator clint;
+	axilite_bus fetch_bus;
+	axilite_bus mem_bus;
+
+	mem.map(&fetch_bus);
+
+	mem_bus.memmap(RVEE_SOC_UART_BASE, RVEE_SOC_UART_SIZE, &uart);
+	mem_bus.memmap(RVEE_SOC_CLINT_BASE, RVEE_SOC_CLINT_SIZE, &clint);
+	mem.map(&mem_bus);
+
+	axilite_target fetch_port(&fetch_bus);
+	axilite_target mem_port(&mem_bus);
+
+	memset(&fetch_pins, 0, sizeof fetch_pins);
+	memset(&mem_pins, 0, sizeof mem_pins);
+	memset(&clint_pins, 0, sizeof clint_pins);
+
+	resetv = mem.load(ramfile, &elf);
+	tohost = mem.tohost(&elf, &tohost_addr);
+
+	if (ff_pc_arg || ff_insns) {
+		if (ff_pc_arg && !rvee_ff_parse_pc(ff_pc_arg, &elf, &ff_pc)) {
+			return EXIT_FAILURE;
+		}
+		ff = new rvee_ff_iss(&uart);
+		for (i = 0; i < mem.regions.size(); i++) {
+			ff->add_mem(mem.regions[i].buf, mem.regions[i].base,
+				    mem.regions[i].size, mem.regions[i].rom);
+		}
+		ff->reset(resetv);
+		ff_t = now();
+		ff->run(ff_pc, ff_insns, tohost);
+		ff_t = now() - ff_t;
+		printf("Fast-forwarded %" PRIu64 " insns to pc %08" PRIx64 "\n",
+		       ff->instret, (uint64_t) ff->pc);
+		resetv = ff->pc;
+		rvee_ff_state = ff;
+	}
+
+	if (plusarg_flag("lockstep")) {
+		lockstep = new rvee_lockstep(resetv);
+		for (i = 0; i < mem.regions.size(); i++) {
+			lockstep->add_mem(mem.regions[i].buf,
+					  mem.regions[i].base,
+					  mem.regions[i].size,
+					  mem.regions[i].rom);
+		}
+		if (ff) {
+			lockstep->iss.set_state(ff);
+		}
+		rvee_lockstep_inst = lockstep;
+	}
+
+	if (commit_trace_file) {
+		commit_trace = new rvee_trace_writer();
+		if (!commit_trace->open(commit_trace_file)) {
+			return EXIT_FAILURE;
+		}
+	}
+
+#if VM_TRACE
+	// If verilator was invoked with --trace or --trace-fst and +trace
+	// was given at run time, trace the model (see trace_ctl.h).
+	tb_trace_c_t *tfp = NULL;
+	if (plusarg_flag("trace")) {
+		char base[256];
+
+		Verilated::traceEverOn(true);
+		tfp = new tb_trace_c_t;
+		tb->trace(tfp, 100);
+
+		snprintf(base, sizeof base, "%s-verilator", argv[0]);
+		wave = new trace_ctl_t<tb_trace_c_t>(base, tfp);
+	}
+#endif
+
+	tb->resetv = resetv;
+	tb->aresetn = 0;
+	tb->aclk = 0;
+	tb->eval();
+
+#ifdef RVEE_TB_SAVABLE
+	// The image is still loaded above for its symbols, the memory
+	// contents come from the checkpoint.
+	if (restore_file) {
+		rvee_ckpt_restore is;
+
+		if (!is.open(restore_file)) {
+			return EXIT_FAILURE;
+		}
+		tb_ckpt(is, tb, &cycles, &fetch_pins, &mem_pins, &clint_pins,
+			&fetch_port, &mem_port, &clint, &mem);
+		if (!is.mem(&mem)) {
+			return EXIT_FAILURE;
+		}
+		is.close();
+		printf("Restored %s at cycle %lu\n", restore_file, cycles);
+	}
+#endif
+
+	t0 = now();
+	while (!uart.exited && !Verilated::gotFinish()) {
+		if (lockstep && lockstep->failed) {
+			break;
+		}
+
+#ifdef RVEE_TB_SAVABLE
+		// Between cycles, nothing is half-way through an edge.
+		if (save_file && ((save_cycle && cycles == save_cycle) ||
+				  uart.ckpt_req)) {
+			rvee_ckpt_save os;
+
+			uart.ckpt_req = false;
+			if (!os.open(save_file)) {
+				break;
+			}
+			tb_ckpt(os, tb, &cycles, &fetch_pins, &mem_pins,
+				&clint_pins, &fetch_port, &mem_port, &clint,
+				&mem);
+			os.mem(&mem);
+			os.close();
+			printf("Saved %s at cycle %lu (%" PRIu64 " pages)\n",
+			       save_file, cycles, os.pages);
+		}
+#endif
+
+		if (max_cycles && cycles >= max_cycles) {
+			printf("Timeout after %lu cycles\n", cycles);
+			break;
+		}
+
+		// Sample the pins prior to the rising edge and compute the
+		// models' next state.
+		AXILITE_PINS_GET_MASTER(&fetch_pins, tb, m00_);
+		AXILITE_PINS_GET_MASTER(&mem_pins, tb, m01_);
+		AXILITE_PINS_GET_TARGET(&clint_pins, tb, s00_);
+
+		if (wave) {
+			wave->clock();
+			if (tb->commit_valid) {
+				wave->pc(tb->commit_pc);
+			}
+		}
+
+		if (commit_trace && tb->commit_valid) {
+			rvee_commit c;
+
+			c.pc = tb->commit_pc;
+			c.iw = tb->commit_iw;
+			c.rd_we = tb->commit_rd_we;
+			c.rd = tb->commit_rd;
+			c.wdata = tb->commit_wdata;
+			c.mem_load = tb->commit_mem_load;
+			c.mem_store = tb->commit_mem_store;
+			c.mem_addr = tb->commit_mem_addr;
+			c.trap = tb->commit_trap;
+			c.trap_entry = tb->commit_trap_entry;
+			commit_trace->put(&c, cycles);
+		}
+
+		if (tohost && tb->commit_valid && tb->commit_mem_store &&
+		    !tb->commit_trap) {
+			rvee_soc_snoop_tohost(tohost_addr, tb->commit_mem_addr,
+					      tb->commit_wdata, &uart);
+		}
+
+		if (!tb->aresetn) {
+			fetch_port.reset(&fetch_pins);
+			mem_port.reset(&mem_pins);
+			clint.reset(&clint_pins);
+		} else {
+			fetch_port.clock(&fetch_pins);
+			mem_port.clock(&mem_pins);
+			clint.clock(&clint_pins);
+		}
+
+		tb->aclk = 1;
+		tb->eval();
+		main_time += 5;
+#if VM_TRACE
+		if (wave && wave->dumping())
+			tfp->dump(main_time * 1000);
+#endif
+
+		// The models' outputs change right after the edge.
+		AXILITE_PINS_PUT_TARGET(tb, &fetch_pins, m00_);
+		AXILITE_PINS_PUT_TARGET(tb, &mem_pins, m01_);
+		AXILITE_PINS_PUT_MASTER(tb, &clint_pins, s00_);
+		cycles++;
+		tb->aresetn = cycles >= RESET_CYCLES;
+
+		tb->aclk = 0;
+		tb->eval();
+		main_time += 5;
+#if VM_TRACE
+		if (wave && wave->dumping())
+			tfp->dump(main_time * 1000);
+#endif
+	}
+	t = now() - t0;
+
+	ret = uart.exited ? uart.exit_code : EXIT_FAILURE;
+	if (lockstep && lockstep->failed) {
+		ret = EXIT_FAILURE;
+	}
+
+	if (perf) {
+		rvee_perf_print(stdout);
+	}
+
+	tb->final();
+	if (wave) {
+		// Windowed traces are only kept for failing runs.
+		wave->finish(ret != 0);
+		delete wave;
+	}
+	delete tb;
+
+	if (stats) {
+		fprintf(stderr, "%lu cycles in %.6f s (%.1f kHz)\n",
+			cycles, t, t > 0 ? cycles / t / 1000 : 0);
+		if (lockstep) {
+			fprintf(stderr, "%" PRIu64 " insns checked in lockstep\n",
+				lockstep->checked);
+		}
+		if (ff) {
+			fprintf(stderr, "%" PRIu64 " insns fast-forwarded in "
+				"%.6f s (%.1f MIPS)\n", ff->instret, ff_t,
+				ff_t > 0 ? ff->instret / ff_t / 1e6 : 0);
+		}
+	}
+
+	rvee_lockstep_inst = NULL;
+	delete lockstep;
+	rvee_ff_state = NULL;
+	delete ff;
+	delete commit_trace;
+	return ret;
+}
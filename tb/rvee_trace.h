@@ -0,0 +1,277 @@
+/*
+ * Binary commit trace, written from the core's commit_* port.
+ *
+ * A trace file is a header followed by one variable length record per
+ * retired insn or trap entry. All fields are little endian.
+ *
+ * Header:
+ *   char     magic[8]	"RVEETRC" + NUL
+ *   uint32_t version	RVEE_TRACE_VERSION
+ *   uint32_t reserved
+ *
+ * Record:
+ *   uint8_t  flags	RVEE_TRACE_F_*
+ *   uleb128  cycles since the previous record
+ *   uint32_t pc	only with RVEE_TRACE_F_PC, otherwise previous pc + 4
+ *   uint32_t iw
+ *   uint8_t  rd, uint32_t data	with RVEE_TRACE_F_RD
+ *   uint32_t addr	with RVEE_TRACE_F_LOAD or RVEE_TRACE_F_STORE
+ *   uint32_t data	with RVEE_TRACE_F_STORE
+ *
+ * Straight line code without memory accesses costs 6 bytes per insn.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_RVEE_TRACE_H__
+#define __TB_RVEE_TRACE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RVEE_TRACE_MAGIC	"RVEETRC"
+#define RVEE_TRACE_VERSION	1
+
+#define RVEE_TRACE_F_PC		(1U << 0)
+#define RVEE_TRACE_F_RD		(1U << 1)
+#define RVEE_TRACE_F_LOAD	(1U << 2)
+#define RVEE_TRACE_F_STORE	(1U << 3)
+#define RVEE_TRACE_F_TRAP	(1U << 4)
+#define RVEE_TRACE_F_TRAP_ENTRY	(1U << 5)
+
+// One sample of the commit port.
+struct rvee_commit {
+	uint32_t pc;
+	uint32_t iw;
+	bool rd_we;
+	unsigned int rd;
+	uint32_t wdata;
+	bool mem_load;
+	bool mem_store;
+	uint32_t mem_addr;
+	bool trap;
+	bool trap_entry;
+};
+
+class rvee_trace_writer {
+public:
+	uint64_t records;
+
+	rvee_trace_writer() :
+		records(0),
+		fp(NULL),
+		next_pc(0),
+		last_cycle(0) {
+	}
+
+	~rvee_trace_writer() {
+		close();
+	}
+
+	bool open(const char *fname) {
+		uint8_t hdr[16];
+
+		fp = fopen(fname, "wb");
+		if (!fp) {
+			perror(fname);
+			return false;
+		}
+		setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
+		memset(hdr, 0, sizeof hdr);
+		memcpy(hdr, RVEE_TRACE_MAGIC, sizeof RVEE_TRACE_MAGIC);
+		put32(hdr + 8, RVEE_TRACE_VERSION);
+		fwrite(hdr, sizeof hdr, 1, fp);
+		return true;
+	}
+
+	void close(void) {
+		if (fp) {
+			fclose(fp);
+			fp = NULL;
+		}
+	}
+
+	void put(const rvee_commit *c, uint64_t cycle) {
+		uint8_t buf[32];
+		uint64_t delta = cycle - last_cycle;
+		unsigned int flags = 0;
+		unsigned int n = 1;
+
+		if (c->pc != next_pc)
+			flags |= RVEE_TRACE_F_PC;
+		if (c->rd_we && c->rd)
+			flags |= RVEE_TRACE_F_RD;
+		if (c->mem_load)
+			flags |= RVEE_TRACE_F_LOAD;
+		if (c->mem_store)
+			flags |= RVEE_TRACE_F_STORE;
+		if (c->trap)
+			flags |= RVEE_TRACE_F_TRAP;
+		if (c->trap_entry)
+			flags |= RVEE_TRACE_F_TRAP_ENTRY;
+
+		buf[0] = flags;
+		do {
+			buf[n] = delta & 0x7f;
+			delta >>= 7;
+			if (delta)
+				buf[n] |= 0x80;
+			n++;
+		} while (delta);
+
+		if (flags & RVEE_TRACE_F_PC) {
+			n += put32(buf + n, c->pc);
+		}
+		n += put32(buf + n, c->iw);
+		if (flags & RVEE_TRACE_F_RD) {
+			buf[n++] = c->rd;
+			n += put32(buf + n, c->wdata);
+		}
+		if (flags & (RVEE_TRACE_F_LOAD | RVEE_TRACE_F_STORE)) {
+			n += put32(buf + n, c->mem_addr);
+		}
+		if (flags & RVEE_TRACE_F_STORE) {
+			n += put32(buf + n, c->wdata);
+		}
+
+		fwrite(buf, n, 1, fp);
+		next_pc = c->pc + 4;
+		last_cycle = cycle;
+		records++;
+	}
+
+private:
+	FILE *fp;
+	uint32_t next_pc;
+	uint64_t last_cycle;
+
+	static unsigned int put32(uint8_t *p, uint32_t v) {
+		p[0] = v;
+		p[1] = v >> 8;
+		p[2] = v >> 16;
+		p[3] = v >> 24;
+		return 4;
+	}
+};
+
+class rvee_trace_reader {
+public:
+	rvee_trace_reader() :
+		fp(NULL),
+		next_pc(0),
+		cycle(0) {
+	}
+
+	~rvee_trace_reader() {
+		if (fp && fp != stdin) {
+			fclose(fp);
+		}
+	}
+
+	// fname "-" reads from stdin.
+	bool open(const char *fname) {
+		uint8_t hdr[16];
+
+		fp = strcmp(fname, "-") ? fopen(fname, "rb") : stdin;
+		if (!fp) {
+			perror(fname);
+			return false;
+		}
+		if (fread(hdr, sizeof hdr, 1, fp) != 1 ||
+		    memcmp(hdr, RVEE_TRACE_MAGIC, sizeof RVEE_TRACE_MAGIC)) {
+			fprintf(stderr, "%s: not a commit trace\n", fname);
+			return false;
+		}
+		if (get32(hdr + 8) != RVEE_TRACE_VERSION) {
+			fprintf(stderr, "%s: unsupported version %u\n",
+				fname, get32(hdr + 8));
+			return false;
+		}
+		return true;
+	}
+
+	// Returns false at the end of the trace. *cyclep is the absolute
+	// cycle count of the record.
+	bool get(rvee_commit *c, uint64_t *cyclep) {
+		unsigned int flags, shift = 0;
+		uint64_t delta = 0;
+		int b;
+
+		flags = getc(fp);
+		if (flags == (unsigned int) EOF) {
+			return false;
+		}
+
+		do {
+			if ((b = getc(fp)) == EOF)
+				return false;
+			delta |= (uint64_t) (b & 0x7f) << shift;
+			shift += 7;
+		} while (b & 0x80);
+
+		memset(c, 0, sizeof *c);
+		c->pc = next_pc;
+		if ((flags & RVEE_TRACE_F_PC) && !read32(&c->pc))
+			return false;
+		if (!read32(&c->iw))
+			return false;
+		if (flags & RVEE_TRACE_F_RD) {
+			if ((b = getc(fp)) == EOF || !read32(&c->wdata))
+				return false;
+			c->rd_we = true;
+			c->rd = b;
+		}
+		c->mem_load = flags & RVEE_TRACE_F_LOAD;
+		c->mem_store = flags & RVEE_TRACE_F_STORE;
+		if ((c->mem_load || c->mem_store) && !read32(&c->mem_addr))
+			return false;
+		if (c->mem_store && !read32(&c->wdata))
+			return false;
+		c->trap = flags & RVEE_TRACE_F_TRAP;
+		c->trap_entry = flags & RVEE_TRACE_F_TRAP_ENTRY;
+
+		next_pc = c->pc + 4;
+		cycle += delta;
+		*cyclep = cycle;
+		return true;
+	}
+
+private:
+	FILE *fp;
+	uint32_t next_pc;
+	uint64_t cycle;
+
+	static uint32_t get32(const uint8_t *p) {
+		return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+	}
+
+	bool read32(uint32_t *v) {
+		uint8_t b[4];
+
+		if (fread(b, sizeof b, 1, fp) != 1)
+			return false;
+		*v = get32(b);
+		return true;
+	}
+};
+#endif
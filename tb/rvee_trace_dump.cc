@@ -0,0 +1,108 @@
+/*
+ * Decode a binary commit trace (see rvee_trace.h) into text.
+ *
+ * Usage: rvee-trace-dump [-s] trace.bin|-
+ *   -s  Only print a summary.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rvee_trace.h"
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-s] trace.bin|-\n", prog);
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+	rvee_trace_reader rd;
+	rvee_commit c;
+	uint64_t cycle = 0, first = 0;
+	uint64_t records = 0, insns = 0, traps = 0, loads = 0, stores = 0;
+	bool summary = false;
+	const char *fname;
+
+	if (argc == 3 && !strcmp(argv[1], "-s")) {
+		summary = true;
+		fname = argv[2];
+	} else if (argc == 2) {
+		fname = argv[1];
+	} else {
+		usage(argv[0]);
+	}
+
+	if (!rd.open(fname)) {
+		return EXIT_FAILURE;
+	}
+
+	while (rd.get(&c, &cycle)) {
+		if (!records) {
+			first = cycle;
+		}
+		records++;
+		if (c.trap_entry) {
+			traps++;
+		} else if (!c.trap) {
+			insns++;
+			loads += c.mem_load;
+			stores += c.mem_store;
+		}
+
+		if (summary) {
+			continue;
+		}
+
+		printf("%10" PRIu64 " %08x %08x", cycle, c.pc, c.iw);
+		if (c.rd_we) {
+			printf(" x%-2u=%08x", c.rd, c.wdata);
+		}
+		if (c.mem_load) {
+			printf(" ld [%08x]", c.mem_addr);
+		}
+		if (c.mem_store) {
+			printf(" st [%08x]=%08x", c.mem_addr, c.wdata);
+		}
+		if (c.trap) {
+			printf(" fault");
+		}
+		if (c.trap_entry) {
+			printf(" trap-entry");
+		}
+		putchar('\n');
+	}
+
+	printf("%" PRIu64 " insns, %" PRIu64 " loads, %" PRIu64 " stores, "
+	       "%" PRIu64 " trap entries, %" PRIu64 " cycles",
+	       insns, loads, stores, traps, records ? cycle - first + 1 : 0);
+	if (insns) {
+		printf(", CPI %.3f", (double) (cycle - first + 1) / insns);
+	}
+	putchar('\n');
+	return 0;
+}
@@ -23,7 +23,25 @@
  * THE SOFTWARE.
  */
 
-#include "verilated_vcd_sc.h"
+#include "plusargs.h"
+#include "trace_ctl_sc.h"
+
+// Dump the log ring and tag errors with the seed and transaction count
+// so that failing runs can be told apart and deduplicated by assertion
+// site.
+static void tb_report_handler(const sc_report& rep, const sc_actions& actions)
+{
+	if (rep.get_severity() >= SC_ERROR) {
+		tb_log_dump();
+		tb_trace_finish(true);
+		printf("FAIL: seed=%u transactions=%" PRIu64 " site=%s:%d %s\n",
+			tb_rand_seed, tb_transactions,
+			rep.get_file_name(), rep.get_line_number(),
+			rep.get_msg());
+		fflush(NULL);
+	}
+	sc_report_handler::default_handler(rep, actions);
+}
 
 int sc_main(int argc, char* argv[])
 {
@@ -36,22 +54,20 @@ int sc_main(int argc, char* argv[])
 	if (argc > 1) {
 		rand_seed = strtoull(argv[1], NULL, 0);
 	}
+	tb_rand_seed = rand_seed;
+
+	// +transactions=N stops after N checked transactions.
+	tb_max_transactions = plusarg_u64("transactions", 0);
+	tb_log_verbose = plusarg_flag("verbose");
+	sc_report_handler::set_handler(tb_report_handler);
 
 	Top top("top", sc_time((double) 100, SC_NS), rand_seed);
 #if VM_TRACE
-	Verilated::traceEverOn(true);
-	// If verilator was invoked with --trace argument,
-	// and if at run time passed the +trace argument, turn on tracing
-	VerilatedVcdSc *tfp = NULL;
-	const char* flag = Verilated::commandArgsPlusMatch("trace");
-	if (flag && !strcmp(flag, "+trace")) {
-		char fname[256];
-		tfp = new VerilatedVcdSc;
-		top.tb.trace(tfp, 100);
-
-		snprintf(fname, sizeof fname, "%s-verilator.vcd", argv[0]);
-		tfp->open(fname);
-
+	// If verilator was invoked with --trace or --trace-fst and +trace
+	// was given at run time, trace the model (see trace_ctl.h).
+	// +trace-sc adds a VCD of the SystemC signals for the whole run.
+	trace_ctl *ctl = trace_ctl_setup(argv[0], top.tb, top.clk);
+	if (plusarg_flag("trace-sc")) {
 		trace_fp = sc_create_vcd_trace_file(argv[0]);
 		trace(trace_fp, top, top.name());
 	}
@@ -62,7 +78,8 @@ int sc_main(int argc, char* argv[])
 	}
 
 #if VM_TRACE
-	delete tfp;
+	tb_trace_ctl = NULL;
+	delete ctl;
 #endif
 	return 0;
 }
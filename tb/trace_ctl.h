@@ -0,0 +1,207 @@
+/*
+ * Waveform trace control.
+ *
+ * Wraps a Verilated VCD or FST trace object and decides when it dumps:
+ *
+ * +trace			Enable waveform tracing.
+ * +trace-start=N		Start at cycle N.
+ * +trace-stop=N		Stop at cycle N.
+ * +trace-start-pc=ADDR		Start when the insn at ADDR retires.
+ * +trace-stop-pc=ADDR		Stop when the insn at ADDR retires.
+ * +trace-window=N		Only keep the last N to 2N cycles and only
+ *				if the run fails.
+ *
+ * PC triggers need a harness that calls pc() for retired insns.
+ *
+ * The window is implemented by rotating the trace file every N cycles
+ * and removing the segment before the previous one. On success, the
+ * remaining segments are removed as well.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_TRACE_CTL_H__
+#define __TB_TRACE_CTL_H__
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+#include "plusargs.h"
+
+#if VM_TRACE_FST
+#define TB_TRACE_EXT ".fst"
+#else
+#define TB_TRACE_EXT ".vcd"
+#endif
+
+class trace_ctl {
+public:
+	uint64_t start_cycle;
+	uint64_t stop_cycle;
+	uint64_t start_pc;
+	uint64_t stop_pc;
+	bool start_on_pc;
+	bool stop_on_pc;
+	uint64_t window;
+
+	trace_ctl(const char *base) :
+		base(base),
+		state(IDLE),
+		cycle(0),
+		seg_start(0) {
+		const char *pc;
+
+		start_cycle = plusarg_u64("trace-start", 0);
+		stop_cycle = plusarg_u64("trace-stop", 0);
+		window = plusarg_u64("trace-window", 0);
+
+		start_on_pc = (pc = plusarg_str("trace-start-pc", NULL));
+		start_pc = start_on_pc ? strtoull(pc, NULL, 0) : 0;
+		stop_on_pc = (pc = plusarg_str("trace-stop-pc", NULL));
+		stop_pc = stop_on_pc ? strtoull(pc, NULL, 0) : 0;
+	}
+
+	virtual ~trace_ctl() {}
+
+	bool dumping(void) {
+		return state == ON;
+	}
+
+	// Called once per cycle, before the rising edge.
+	void clock(void) {
+		if (state == IDLE && !start_on_pc && cycle >= start_cycle) {
+			start();
+		}
+		if (state == ON && stop_cycle && cycle >= stop_cycle) {
+			stop();
+		}
+		if (state == ON && window && cycle - seg_start >= window) {
+			trace_close();
+			drop_segment(prev_fname);
+			prev_fname = fname;
+			start();
+		}
+		cycle++;
+	}
+
+	// Called for every retired insn.
+	void pc(uint64_t pc) {
+		if (state == IDLE && start_on_pc && pc == start_pc) {
+			start();
+		}
+		if (state == ON && stop_on_pc && pc == stop_pc) {
+			stop();
+		}
+	}
+
+	// Ends tracing. Windowed traces are kept only if failed.
+	void finish(bool failed) {
+		if (state == ON) {
+			stop();
+		}
+		if (window && !failed) {
+			drop_segment(prev_fname);
+			drop_segment(fname);
+		} else if (window && !fname.empty()) {
+			fprintf(stderr, "Trace window kept in %s%s%s\n",
+				prev_fname.c_str(), prev_fname.empty() ? "" : " ",
+				fname.c_str());
+		}
+		prev_fname.clear();
+		fname.clear();
+	}
+
+protected:
+	virtual void trace_open(const char *fname) = 0;
+	virtual void trace_close(void) = 0;
+
+private:
+	std::string base;
+	enum { IDLE, ON, STOPPED } state;
+	uint64_t cycle;
+	uint64_t seg_start;
+	std::string fname;
+	std::string prev_fname;
+
+	void start(void) {
+		char suffix[32] = "";
+
+		if (window) {
+			snprintf(suffix, sizeof suffix, "-%" PRIu64, cycle);
+		}
+		fname = base + suffix + TB_TRACE_EXT;
+		trace_open(fname.c_str());
+		seg_start = cycle;
+		state = ON;
+	}
+
+	void stop(void) {
+		trace_close();
+		state = STOPPED;
+	}
+
+	void drop_segment(std::string &f) {
+		if (!f.empty()) {
+			unlink(f.c_str());
+			f.clear();
+		}
+	}
+};
+
+// T is one of Verilator's VCD/FST trace classes (C or SystemC).
+// We take ownership of tfp.
+template <class T>
+class trace_ctl_t : public trace_ctl {
+public:
+	T *tfp;
+
+	trace_ctl_t(const char *base, T *tfp) :
+		trace_ctl(base),
+		tfp(tfp) {
+	}
+
+	~trace_ctl_t() {
+		finish(false);
+		delete tfp;
+	}
+
+protected:
+	void trace_open(const char *fname) {
+		tfp->open(fname);
+	}
+
+	void trace_close(void) {
+		tfp->close();
+	}
+};
+
+// The harness' trace controller, for the failure paths.
+static trace_ctl *tb_trace_ctl;
+
+static inline void tb_trace_finish(bool failed)
+{
+	if (tb_trace_ctl) {
+		tb_trace_ctl->finish(failed);
+	}
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+ * SystemC glue for trace_ctl.h.
+ *
+ * Copyright (c) 2022 Edgar E. Iglesias.
+ * Written by Edgar E. Iglesias <edgar.iglesias@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TB_TRACE_CTL_SC_H__
+#define __TB_TRACE_CTL_SC_H__
+
+#include "systemc.h"
+
+#if VM_TRACE_FST
+#include "verilated_fst_sc.h"
+typedef VerilatedFstSc tb_trace_sc_t;
+#else
+#include "verilated_vcd_sc.h"
+typedef VerilatedVcdSc tb_trace_sc_t;
+#endif
+
+#include "trace_ctl.h"
+
+// Clocks a trace_ctl from the testbench clock.
+SC_MODULE(trace_ctl_clock)
+{
+	trace_ctl *ctl;
+
+	SC_HAS_PROCESS(trace_ctl_clock);
+
+	trace_ctl_clock(sc_module_name name, trace_ctl *ctl,
+			sc_clock &clk) :
+		sc_module(name),
+		ctl(ctl)
+	{
+		SC_METHOD(tick);
+		sensitive << clk.posedge_event();
+		dont_initialize();
+	}
+
+	void tick(void) {
+		ctl->clock();
+	}
+};
+
+// Sets up tracing of model m if +trace was given. Returns the
+// controller, or NULL.
+template <class M>
+static trace_ctl *trace_ctl_setup(const char *prog, M &m, sc_clock &clk)
+{
+	trace_ctl_t<tb_trace_sc_t> *ctl;
+	tb_trace_sc_t *tfp;
+	char base[256];
+
+	if (!plusarg_flag("trace")) {
+		return NULL;
+	}
+
+	Verilated::traceEverOn(true);
+	tfp = new tb_trace_sc_t;
+	m.trace(tfp, 100);
+
+	snprintf(base, sizeof base, "%s-verilator", prog);
+	ctl = new trace_ctl_t<tb_trace_sc_t>(base, tfp);
+	new trace_ctl_clock("trace-ctl", ctl, clk);
+	tb_trace_ctl = ctl;
+	return ctl;
+}
+#endif
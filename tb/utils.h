@@ -1,3 +1,4 @@
+#include <type_traits>
 
 static inline void rand_buf_r(unsigned int *seedp, void *buf, size_t n) {
 	size_t i;
@@ -10,3 +11,166 @@ static inline void rand_buf_r(unsigned int *seedp, void *buf, size_t n) {
 		memcpy((char *)buf + i, &r, sizeof r <= space ? sizeof r : space);
 	}
 }
+
+// Logging.
+//
+// TB_LOG_LEVEL selects at compile time which messages go straight to
+// stdout. Messages above it, up to TB_LOG_RING_LEVEL, go to a ring
+// buffer holding the last TB_LOG_RING_SIZE messages. The ring keeps the
+// format string and the raw args and only formats them when it's dumped,
+// which only happens when an assertion fires (see sc_main.h), so passing
+// runs stay quiet and cheap. Messages above both levels compile away.
+//
+// Ring messages take at most TB_LOG_ARGS_MAX integer or pointer args,
+// the format must be a string literal and %s args must outlive the run.
+//
+// At runtime, +verbose sends ring messages to stdout as well.
+#define TB_LOG_ERR	0
+#define TB_LOG_INFO	1
+#define TB_LOG_DEBUG	2
+
+#ifndef TB_LOG_LEVEL
+#define TB_LOG_LEVEL TB_LOG_INFO
+#endif
+#ifndef TB_LOG_RING_LEVEL
+#define TB_LOG_RING_LEVEL TB_LOG_DEBUG
+#endif
+#ifndef TB_LOG_RING_SIZE
+#define TB_LOG_RING_SIZE 64
+#endif
+#define TB_LOG_ARGS_MAX 24
+
+static struct {
+	uint64_t wr;
+	uint64_t stamp[TB_LOG_RING_SIZE];
+	const char *fmt[TB_LOG_RING_SIZE];
+	uint64_t args[TB_LOG_RING_SIZE][TB_LOG_ARGS_MAX];
+} tb_log_ring;
+static bool tb_log_verbose;
+
+template <typename T>
+static inline uint64_t tb_log_arg(T v) {
+	static_assert(std::is_integral<T>::value || std::is_enum<T>::value ||
+		      std::is_pointer<T>::value,
+		      "TB_LOG ring args must be integers or pointers");
+	return (uint64_t) v;
+}
+
+template <typename... Args>
+static inline void tb_log_ring_put(const char *fmt, Args... args) {
+	static_assert(sizeof...(args) <= TB_LOG_ARGS_MAX,
+		      "too many TB_LOG args");
+	// Leading 0 keeps the array non-empty for arg-less messages.
+	const uint64_t v[] = { 0, tb_log_arg(args)... };
+	unsigned int i = tb_log_ring.wr++ % TB_LOG_RING_SIZE;
+
+	tb_log_ring.stamp[i] = sc_time_stamp().value();
+	tb_log_ring.fmt[i] = fmt;
+	memcpy(tb_log_ring.args[i], v + 1, sizeof...(args) * sizeof v[0]);
+}
+
+// Print a ring message. The args were widened to 64 bits when logged,
+// so each conversion is printed on its own with the length modifier
+// rewritten to match. '*' widths aren't supported.
+static inline void tb_log_print(const char *fmt, const uint64_t *args) {
+	unsigned int n = 0;
+
+	while (*fmt) {
+		const char *s = fmt;
+		char spec[32];
+		size_t len;
+		bool wide = false;
+
+		if (*fmt != '%') {
+			putchar(*fmt++);
+			continue;
+		}
+		if (fmt[1] == '%') {
+			putchar('%');
+			fmt += 2;
+			continue;
+		}
+
+		for (fmt++; *fmt && strchr("-+ #0123456789.", *fmt); fmt++);
+		len = fmt - s;
+		for (; *fmt && strchr("hljzt", *fmt); fmt++) {
+			wide |= *fmt != 'h';
+		}
+		if (!*fmt || len + 4 > sizeof spec || n >= TB_LOG_ARGS_MAX) {
+			fputs(s, stdout);
+			return;
+		}
+
+		memcpy(spec, s, len);
+		if (wide) {
+			spec[len++] = 'l';
+			spec[len++] = 'l';
+		}
+		spec[len++] = *fmt;
+		spec[len] = 0;
+
+		switch (*fmt++) {
+		case 's':
+			printf(spec, (const char *) (uintptr_t) args[n++]);
+			break;
+		case 'p':
+			printf(spec, (void *) (uintptr_t) args[n++]);
+			break;
+		default:
+			if (wide) {
+				printf(spec, (unsigned long long) args[n++]);
+			} else {
+				printf(spec, (unsigned int) args[n++]);
+			}
+			break;
+		}
+	}
+}
+
+static inline void tb_log_dump(void) {
+	uint64_t n = tb_log_ring.wr;
+	uint64_t i = n > TB_LOG_RING_SIZE ? n - TB_LOG_RING_SIZE : 0;
+
+	if (!n || tb_log_verbose) {
+		return;
+	}
+
+	printf("--- last %" PRIu64 " log messages ---\n", n - i);
+	for (; i < n; i++) {
+		unsigned int e = i % TB_LOG_RING_SIZE;
+
+		// Lines normally carry their own newline.
+		printf("%" PRIu64 ": ", tb_log_ring.stamp[e]);
+		tb_log_print(tb_log_ring.fmt[e], tb_log_ring.args[e]);
+	}
+	printf("--- end of log ---\n");
+}
+
+#define TB_LOG(level, ...)						\
+	do {								\
+		if ((level) <= TB_LOG_LEVEL ||				\
+		    ((level) <= TB_LOG_RING_LEVEL && tb_log_verbose)) {	\
+			printf(__VA_ARGS__);				\
+		} else if ((level) <= TB_LOG_RING_LEVEL) {		\
+			tb_log_ring_put(__VA_ARGS__);			\
+		}							\
+	} while (0)
+
+// Bounded runs.
+//
+// sc_main.h sets tb_max_transactions from +transactions=N and the TBs
+// call tb_transaction_done() once per checked transaction. Once N
+// transactions have been checked the simulation stops and sc_main
+// returns success.
+static unsigned int tb_rand_seed;
+static uint64_t tb_transactions;
+static uint64_t tb_max_transactions;
+
+static inline void tb_transaction_done(void) {
+	tb_transactions++;
+	if (tb_max_transactions && tb_transactions == tb_max_transactions) {
+		printf("PASS: seed=%u transactions=%" PRIu64 "\n",
+			tb_rand_seed, tb_transactions);
+		sc_stop();
+	}
+}